@@ -0,0 +1,331 @@
+// Microbenchmarks for the game engine: board moves, link lookup, decorator
+// chains, abilities, turn handling, state capture, the text view and
+// command parsing.
+//
+// Each benchmark is timed in batches sized to take at least a millisecond.
+// Batches are repeated and the median and minimum time per operation are
+// reported with the median absolute deviation as a measure of noise. The
+// output is one JSON object per line, so two runs can be compared with any
+// JSON tool; the first line describes the build.
+//
+// Benchmarks that change the game irreversibly (battles, abilities) are
+// given a fresh game for every operation, set up outside the timed region.
+//
+// Usage: bench_engine [filter]; runs the benchmarks whose name contains
+// filter, or all of them. Build with `make clean && make OPT=-O2 bench` for
+// numbers worth comparing; the first line records whether that was done.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ability.h"
+#include "board.h"
+#include "cell.h"
+#include "controller.h"
+#include "game.h"
+#include "gamestate.h"
+#include "link.h"
+#include "linkmanager.h"
+#include "player.h"
+#include "tokenizer.h"
+#include "views.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using LinkKey = LinkManager::LinkKey;
+
+constexpr unsigned batches = 15;
+constexpr std::size_t maxBatch = 1 << 20;
+constexpr std::size_t maxFreshGames = 512;  // each game is ~20 KB
+const auto minBatchTime = std::chrono::milliseconds{1};
+
+std::ostream nowhere{nullptr};  // discards game and view output
+
+const std::vector<std::string> abilities{"FDLPSWQp", "FDLPS"};
+const std::vector<std::vector<std::string>> placements{
+    {"D1", "D2", "D3", "D4", "V1", "V2", "V3", "V4"},
+    {"D1", "D2", "D3", "D4", "V1", "V2", "V3", "V4"}};
+
+std::string_view filter;
+
+// keeps the compiler from discarding a result
+template <typename T>
+void keep(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+std::unique_ptr<Game> newGame() {
+    auto game = std::make_unique<Game>();
+    game->setOutput(nowhere);
+    game->reset(2, abilities, placements);
+    return game;
+}
+
+Player *player(Game &game, unsigned i) { return game.getPlayers()[i]; }
+
+std::pair<int, int> coordsOf(Game &game, unsigned owner, unsigned id) {
+    return game.getLinkManager().getLink({player(game, owner), id}).getCoords();
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    std::size_t n = values.size();
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+void report(std::string_view name, std::size_t batch,
+            const std::vector<double> &perOp) {
+    double mid = median(perOp);
+    std::vector<double> deviations;
+    for (double v : perOp) deviations.push_back(std::abs(v - mid));
+    std::cout << "{\"name\":\"" << name << "\",\"ns\":" << mid
+              << ",\"min\":" << *std::min_element(perOp.begin(), perOp.end())
+              << ",\"mad\":" << median(deviations)
+              << ",\"batches\":" << perOp.size() << ",\"batch\":" << batch
+              << "}" << std::endl;
+}
+
+/**
+ * Times op(i) for i in [0, batch), with batches of at most limit.
+ * setup(batch) runs untimed before every batch.
+ */
+template <typename Setup, typename Op>
+void run(std::string_view name, std::size_t limit, Setup setup, Op op) {
+    if (name.find(filter) == std::string_view::npos) return;
+    auto timeBatch = [&](std::size_t batch) {
+        setup(batch);
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < batch; ++i) op(i);
+        return Clock::now() - start;
+    };
+
+    // grow the batch until it is long enough to time reliably; this also
+    // warms up caches and the allocator
+    std::size_t batch = 1;
+    while (batch < limit && timeBatch(batch) < minBatchTime) batch *= 2;
+    batch = std::min(batch, limit);
+
+    std::vector<double> perOp;
+    for (unsigned b = 0; b < batches; ++b) {
+        double ns = std::chrono::duration<double, std::nano>(timeBatch(batch))
+                        .count();
+        perOp.push_back(ns / batch);
+    }
+    report(name, batch, perOp);
+}
+
+template <typename Op>
+void run(std::string_view name, Op op) {
+    run(name, maxBatch, [](std::size_t) {}, op);
+}
+
+/**
+ * Runs op once on each of a batch of freshly reset games.
+ */
+template <typename Prepare, typename Op>
+void runFresh(std::string_view name, Prepare prepare, Op op) {
+    std::vector<std::unique_ptr<Game>> games;
+    run(
+        name, maxFreshGames,
+        [&](std::size_t batch) {
+            while (games.size() < batch) games.push_back(newGame());
+            for (std::size_t i = 0; i < batch; ++i) {
+                games[i]->reset(2, abilities, placements);
+                prepare(*games[i]);
+            }
+        },
+        [&](std::size_t i) { op(*games[i]); });
+}
+
+template <typename Op>
+void runFresh(std::string_view name, Op op) {
+    runFresh(name, [](Game &) {}, op);
+}
+
+void boardBenchmarks() {
+    auto game = newGame();
+    Board &board = game->getBoard();
+
+    // player 1's link a steps back and forth between empty cells
+    auto from = coordsOf(*game, 0, 0);
+    std::pair<int, int> to{4, from.second};
+    run(
+        "board/moveLink/empty", maxBatch,
+        [&](std::size_t) { game->flushUpdates(); },
+        [&](std::size_t) {
+            board.moveLink(from, to, game.get());
+            std::swap(from, to);
+        });
+
+    // player 1's strongest virus, h, lands on player 2's A
+    runFresh("board/moveLink/battle", [](Game &g) {
+        g.getBoard().moveLink(coordsOf(g, 0, 7), coordsOf(g, 1, 0), &g);
+    });
+}
+
+void linkBenchmarks() {
+    auto game = newGame();
+    LinkManager &links = game->getLinkManager();
+    LinkKey keys[16];
+    for (unsigned i = 0; i < 16; ++i) keys[i] = {player(*game, i / 8), i % 8};
+    run("links/getLink", [&](std::size_t i) {
+        keep(links.getLink(keys[i % 16]));
+    });
+    run("links/hasLink", [&](std::size_t i) {
+        keep(links.hasLink(keys[i % 16]));
+    });
+}
+
+void decoratorBenchmarks() {
+    for (unsigned depth : {0u, 1u, 4u, 16u}) {
+        auto game = newGame();
+        LinkKey key{player(*game, 0), 0};
+        std::function<ArenaPtr<Link>(ArenaPtr<Link>)> boost =
+            [&](ArenaPtr<Link> base) {
+                return makeArena<LinkBoostDecorator>(game->getArena(),
+                                                     std::move(base));
+            };
+        for (unsigned d = 0; d < depth; ++d) {
+            game->getLinkManager().applyDecorator(key, boost);
+        }
+        Link &link = game->getLinkManager().getLink(key);
+        std::string suffix = "/depth" + std::to_string(depth);
+        run("decorators/getType" + suffix, [&](std::size_t) {
+            keep(link.getType());
+        });
+        run("decorators/getCoords" + suffix, [&](std::size_t) {
+            keep(link.getCoords());
+        });
+    }
+}
+
+AbilityArgs linkArgs(char first, char second = 0) {
+    AbilityArgs args;
+    args.count = second ? 2 : 1;
+    args.linkIds[0] = first;
+    args.linkIds[1] = second;
+    return args;
+}
+
+void abilityBenchmarks() {
+    // player 1's abilities are FDLPSWQp, numbered from 1
+    AbilityArgs firewall;
+    firewall.count = 2;
+    firewall.numeric[0] = firewall.numeric[1] = true;
+    firewall.values[0] = 3;  // column
+    firewall.values[1] = 5;  // row, counting the goal row as 1
+    const std::pair<int, AbilityArgs> uses[] = {
+        {1, firewall},           {2, linkArgs('A')},
+        {3, linkArgs('a')},      {4, linkArgs('a')},
+        {5, linkArgs('A')},      {6, linkArgs('a', 'b')},
+        {7, linkArgs('a', 'b')},
+    };
+    for (const auto &[id, args] : uses) {
+        auto game = newGame();
+        std::string name{
+            player(*game, 0)->getAbilities()[id - 1]->getName()};
+        runFresh("abilities/" + name,
+                 [&, id = id, &args = args](Game &g) {
+                     g.useAbility(id, args);
+                 });
+    }
+
+    // Papple needs player 1 in all four corners next to the goal rows;
+    // links a and h start in two of them, and d and c take the other two
+    // from player 2's H and A
+    runFresh(
+        "abilities/Papple",
+        [](Game &g) {
+            g.getBoard().moveLink(coordsOf(g, 0, 3), {1, 7}, &g);
+            g.getBoard().moveLink(coordsOf(g, 0, 2), {8, 0}, &g);
+        },
+        [](Game &g) { g.useAbility(8, {}); });
+}
+
+void gameBenchmarks() {
+    auto game = newGame();
+    run("game/checkWinLoss", [&](std::size_t) { keep(game->checkWinLoss()); });
+    run("game/nextTurn", [&](std::size_t) { game->nextTurn(); });
+    run("game/getPlayers", [&](std::size_t) { keep(game->getPlayers()); });
+}
+
+void stateBenchmarks() {
+    // a state holds five abilities a player, as on the command line
+    auto game = newGame();
+    game->reset(2, {"FDLPS", "FDLPS"}, placements);
+    GameState state;
+    // what --shm does after every turn
+    run("state/capture", [&](std::size_t) {
+        GameState::capture(*game, state);
+        keep(state);
+    });
+}
+
+void viewBenchmarks() {
+    auto game = newGame();
+    TextView view{game.get(), player(*game, 0), nowhere};
+    run("views/TextView/update", [&](std::size_t i) {
+        view.update(View::CellUpdate{int(i % 10), int(i / 10 % 8)});
+    });
+    run("views/TextView/display", [&](std::size_t) { view.display(); });
+}
+
+void parsingBenchmarks() {
+    run("parsing/tokenize", [](std::size_t) {
+        Tokenizer tokens{"ability 3 a B"};
+        for (auto token = tokens.next(); !token.empty();
+             token = tokens.next()) {
+            keep(token);
+        }
+    });
+
+    Controller controller{nowhere};
+    GameConfig config;
+    config.seed = 1;
+    controller.start(config);
+    run("parsing/runCommands/unknown", [&](std::size_t) {
+        controller.runCommands("frobnicate a N");
+    });
+    run("parsing/runCommands/abilities", [&](std::size_t) {
+        controller.runCommands("abilities");
+    });
+    run("parsing/runCommands/rejectedMove", [&](std::size_t) {
+        // player 1 has no link z; the move is parsed, then refused
+        controller.runCommands("move z N");
+    });
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) filter = argv[1];
+#ifdef __OPTIMIZE__
+    const bool optimized = true;
+#else
+    const bool optimized = false;
+#endif
+    std::cout << "{\"benchmark\":\"engine\",\"compiler\":\"" << __VERSION__
+              << "\",\"optimized\":" << (optimized ? "true" : "false") << "}"
+              << std::endl;
+    try {
+        boardBenchmarks();
+        linkBenchmarks();
+        decoratorBenchmarks();
+        abilityBenchmarks();
+        gameBenchmarks();
+        stateBenchmarks();
+        viewBenchmarks();
+        parsingBenchmarks();
+    } catch (const std::exception &e) {
+        std::cerr << "Benchmark setup failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,113 @@
+// Render-time benchmark for Xwindow: draws a board-sized scene with the
+// immediate-mode primitives and with the batched command buffer.
+//
+// Needs an X server; run headless with `make bench-x`, which runs it under
+// `xvfb-run -a`. No figures have been recorded for the batching yet, so
+// whether it pays off on a real server is still open.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "window.h"
+
+namespace {
+
+const int cells = 8;
+const int cellSize = 60;
+const int gridX = 50;
+const int gridY = 110;
+
+// Roughly what GraphicsView issues for a full board: one clear, one base
+// square and one indicator per cell, plus the grid lines.
+void drawImmediate(Xwindow &w) {
+    for (int r = 0; r < cells; ++r) {
+        for (int c = 0; c < cells; ++c) {
+            int x = gridX + c * cellSize;
+            int y = gridY + r * cellSize;
+            w.fillRectangle(x + 2, y + 2, cellSize - 3, cellSize - 3,
+                            Xwindow::White);
+            w.fillRectangle(x + 5, y + 5, cellSize - 10, cellSize - 10,
+                            (r + c) % 2 ? Xwindow::lPurple : Xwindow::lGreen);
+            w.fillRectangle(x + 25, y + 25, cellSize / 3, cellSize / 3,
+                            (r * c) % 3 ? Xwindow::Black : Xwindow::dRed);
+        }
+    }
+    for (int i = 0; i <= cells; ++i) {
+        w.drawLine(gridX + i * cellSize, gridY, gridX + i * cellSize,
+                   gridY + cells * cellSize, 2, Xwindow::Black);
+        w.drawLine(gridX, gridY + i * cellSize, gridX + cells * cellSize,
+                   gridY + i * cellSize, 2, Xwindow::Black);
+    }
+}
+
+void drawBatched(Xwindow &w) {
+    for (int r = 0; r < cells; ++r) {
+        for (int c = 0; c < cells; ++c) {
+            w.queueRectangle(gridX + c * cellSize + 2, gridY + r * cellSize + 2,
+                             cellSize - 3, cellSize - 3, Xwindow::White);
+        }
+    }
+    w.flushBatch();
+    for (int r = 0; r < cells; ++r) {
+        for (int c = 0; c < cells; ++c) {
+            w.queueRectangle(gridX + c * cellSize + 5, gridY + r * cellSize + 5,
+                             cellSize - 10, cellSize - 10,
+                             (r + c) % 2 ? Xwindow::lPurple : Xwindow::lGreen);
+        }
+    }
+    w.flushBatch();
+    for (int r = 0; r < cells; ++r) {
+        for (int c = 0; c < cells; ++c) {
+            w.queueRectangle(gridX + c * cellSize + 25,
+                             gridY + r * cellSize + 25, cellSize / 3,
+                             cellSize / 3,
+                             (r * c) % 3 ? Xwindow::Black : Xwindow::dRed);
+        }
+    }
+    for (int i = 0; i <= cells; ++i) {
+        w.queueLine(gridX + i * cellSize, gridY, gridX + i * cellSize,
+                    gridY + cells * cellSize, 2, Xwindow::Black);
+        w.queueLine(gridX, gridY + i * cellSize, gridX + cells * cellSize,
+                    gridY + i * cellSize, 2, Xwindow::Black);
+    }
+    w.flushBatch();
+}
+
+// returns the mean time per frame in microseconds
+template <typename F>
+double run(const std::string &name, Xwindow &w, int frames, F draw) {
+    // warm up the connection and the server's caches
+    for (int i = 0; i < 10; ++i) draw(w);
+    w.sync();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        draw(w);
+        w.display();
+        w.sync();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double us =
+        std::chrono::duration<double, std::micro>(end - start).count() / frames;
+    std::cout << name << " frames=" << frames << " us_per_frame=" << us
+              << "\n";
+    return us;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 1000;
+    try {
+        Xwindow w(1000, 700);
+        double immediate = run("immediate", w, frames, drawImmediate);
+        double batched = run("batched", w, frames, drawBatched);
+        std::cout << "speedup=" << immediate / batched << "\n";
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what()
+                  << "; run under `xvfb-run -a` or `make bench-x`\n";
+        return 2;
+    }
+}
@@ -1,13 +1,29 @@
 // ability.h
 #pragma once
 
-#include <string>
-#include <vector>
+#include <string_view>
 
 #include "linkmanager.h"
 
 class Game;
 
+/**
+ * @brief Pre-parsed arguments of an `ability` command.
+ *
+ * Every argument is stored both as the link id it would name and, when the
+ * whole token is a number, as that number, so each ability can read the form
+ * it needs without parsing strings. Only a one-character token names a link.
+ */
+struct AbilityArgs {
+    static constexpr unsigned maxArgs = 2; /**< Most arguments any ability
+                                              takes. */
+    unsigned count = 0; /**< Number of arguments given; may exceed maxArgs. */
+    char linkIds[maxArgs] = {}; /**< Each argument if it is one character,
+                                   or 0, which names no link. */
+    int values[maxArgs] = {};   /**< Numeric value of each argument. */
+    bool numeric[maxArgs] = {}; /**< Whether each argument is a number. */
+};
+
 /**
  * @brief Abstract base class for all player abilities (Strategy interface).
  *
@@ -17,7 +33,8 @@ class Game;
  */
 class Ability {
    protected:
-    std::string name;  /**< The name of the ability. */
+    std::string_view name; /**< The name of the ability; a literal, so
+                              abilities allocate nothing. */
     bool used = false; /**< Flag indicating if the ability has been used in the
                           current turn/game. */
 
@@ -34,9 +51,9 @@ class Ability {
    public:
     /**
      * @brief Constructor for the Ability class.
-     * @param name The name of the ability.
+     * @param name The name of the ability, which must outlive it.
      */
-    Ability(std::string name);
+    Ability(std::string_view name);
 
     /**
      * @brief Virtual destructor for the Ability class.
@@ -51,10 +68,9 @@ class Ability {
      *
      * @param game A reference to the Game instance, allowing the ability to
      * interact with game state.
-     * @param params A vector of strings containing any parameters required for
-     * the ability's use.
+     * @param args The parsed arguments given with the ability.
      */
-    virtual void use(Game &game, const std::vector<std::string> &params) = 0;
+    virtual void use(Game &game, const AbilityArgs &args) = 0;
 
     /**
      * @brief Checks if the ability has been used.
@@ -71,7 +87,7 @@ class Ability {
      * @brief Gets the name of the ability.
      * @return The name of the ability.
      */
-    std::string getName() const;
+    std::string_view getName() const;
 };
 
 // Concrete ability implementations
@@ -91,10 +107,10 @@ class FirewallAbility : public Ability {
     /**
      * @brief Uses the Firewall ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing parameters (i.e.
+     * @param args The parsed arguments (i.e.
      * coordinates).
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
 
 /**
@@ -112,9 +128,9 @@ class DownloadAbility : public Ability {
     /**
      * @brief Uses the Download ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing parameters (i.e. link ID).
+     * @param args The parsed arguments (i.e. link ID).
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
 
 /**
@@ -132,9 +148,9 @@ class LinkBoostAbility : public Ability {
     /**
      * @brief Uses the Link Boost ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing parameters (i.e. link ID).
+     * @param args The parsed arguments (i.e. link ID).
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
 
 /**
@@ -153,9 +169,9 @@ class PolarizeAbility : public Ability {
     /**
      * @brief Uses the Polarize ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing parameters (i.e. link ID).
+     * @param args The parsed arguments (i.e. link ID).
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
 
 /**
@@ -173,10 +189,10 @@ class ScanAbility : public Ability {
     /**
      * @brief Uses the Scan ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing parameters (i.e.
+     * @param args The parsed arguments (i.e.
      * link ID).
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
 
 /**
@@ -193,10 +209,10 @@ class WormHoleAbility : public Ability {
     /**
      * @brief Uses the WormHole ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing parameters (i.e. IDs of two
+     * @param args The parsed arguments (i.e. IDs of two
      * links to swap).
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
 
 /**
@@ -215,10 +231,10 @@ class QuantumEntanglementAbility : public Ability {
     /**
      * @brief Uses the Quantum Entanglement ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing parameters (i.e. IDs of two
+     * @param args The parsed arguments (i.e. IDs of two
      * links to entangle).
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
 
 /**
@@ -237,8 +253,7 @@ class PappleAbility : public Ability {
     /**
      * @brief Uses the Papple ability.
      * @param game A reference to the Game instance.
-     * @param params A vector of strings containing any necessary parameters
-     * (i.e. ).
+     * @param args The parsed arguments; Papple takes none.
      */
-    void use(Game &game, const std::vector<std::string> &params) override;
+    void use(Game &game, const AbilityArgs &args) override;
 };
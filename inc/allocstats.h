@@ -0,0 +1,73 @@
+// allocstats.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Subsystems that heap allocations are charged to.
+ */
+enum class AllocTag : uint8_t {
+    Other,      /**< Nothing more specific is running. */
+    Game,       /**< Game rules outside the subsystems below. */
+    Board,      /**< Cells and moves on the board. */
+    Links,      /**< Creating and looking up links. */
+    Decorators, /**< Wrapping links in ability decorators. */
+    Views,      /**< Updating and drawing views. */
+    Parsing,    /**< Reading and dispatching commands. */
+    Updates,    /**< Queueing view updates. */
+    Publish,    /**< Publishing state to shared memory; should stay zero. */
+    Count       /**< Number of tags; not a tag. */
+};
+
+/**
+ * @brief Counts heap allocations by subsystem.
+ *
+ * Only built with `make ALLOC_STATS=1`, which replaces the global
+ * `operator new` and `operator delete`. Each allocation is charged to the
+ * innermost Scope on the allocating thread. Counts are for the whole
+ * process, so a server's workers add to the same totals. In a normal build
+ * scopes compile to nothing and print() says how to turn counting on.
+ */
+class AllocStats {
+   public:
+    /**
+     * @brief Charges allocations on this thread to a subsystem until
+     * destroyed.
+     */
+    class Scope {
+#ifdef ALLOC_STATS
+        AllocTag previous; /**< Tag to go back to. */
+
+       public:
+        /**
+         * @brief Starts charging to a subsystem.
+         * @param tag The subsystem.
+         */
+        explicit Scope(AllocTag tag);
+
+        /**
+         * @brief Goes back to the enclosing scope's subsystem.
+         */
+        ~Scope();
+#else
+       public:
+        explicit Scope(AllocTag) {}
+#endif
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * @brief Marks the end of a turn, for the per-turn figures.
+     */
+    static void endTurn();
+
+    /**
+     * @brief Prints allocations and bytes by subsystem, in total and per
+     * turn, and the heap currently in use.
+     * @param out Where to print.
+     */
+    static void print(std::ostream& out);
+};
@@ -0,0 +1,96 @@
+// arena.h
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Deleter for objects made with makeArena.
+ *
+ * Runs the object's destructor and returns its memory to the resource it
+ * came from. The size and alignment are those of the type that was made, so
+ * an ArenaPtr to a base class frees the whole derived object.
+ */
+struct ArenaDelete {
+    std::pmr::memory_resource *resource =
+        nullptr;            /**< Where the object's memory came from. */
+    std::size_t size = 0;  /**< Size of the object that was made. */
+    std::size_t align = 0; /**< Alignment of the object that was made. */
+
+    /**
+     * @brief Destroys an object and returns its memory.
+     * @param object The object, possibly through a pointer to a base class.
+     */
+    template <typename T>
+    void operator()(T *object) const {
+        void *memory;
+        if constexpr (std::is_polymorphic_v<T>) {
+            memory = dynamic_cast<void *>(object);
+        } else {
+            memory = object;
+        }
+        object->~T();
+        resource->deallocate(memory, size, align);
+    }
+};
+
+/**
+ * @brief Owns an object allocated from a memory resource, usually a game's
+ * arena.
+ */
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDelete>;
+
+/**
+ * @brief Constructs an object in memory from a resource.
+ * @param resource Where to allocate; must outlive the object.
+ * @param args Arguments for the object's constructor.
+ * @return The object.
+ */
+template <typename T, typename... Args>
+ArenaPtr<T> makeArena(std::pmr::memory_resource *resource, Args &&...args) {
+    void *memory = resource->allocate(sizeof(T), alignof(T));
+    try {
+        T *object = ::new (memory) T(std::forward<Args>(args)...);
+        return ArenaPtr<T>{object, {resource, sizeof(T), alignof(T)}};
+    } catch (...) {
+        resource->deallocate(memory, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+/**
+ * @brief Passes allocations on to the heap and keeps count of the bytes
+ * held; an arena's upstream, to show how far it has outgrown its buffer.
+ */
+class CountingResource : public std::pmr::memory_resource {
+    std::size_t held = 0; /**< Bytes allocated and not yet freed. */
+
+    void *do_allocate(std::size_t bytes, std::size_t align) override {
+        void *memory =
+            std::pmr::new_delete_resource()->allocate(bytes, align);
+        held += bytes;
+        return memory;
+    }
+
+    void do_deallocate(void *memory, std::size_t bytes,
+                       std::size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(memory, bytes, align);
+        held -= bytes;
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+   public:
+    /**
+     * @return Bytes currently allocated through this resource.
+     */
+    std::size_t getHeld() const { return held; }
+};
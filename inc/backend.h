@@ -0,0 +1,119 @@
+// backend.h
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Abstract drawing surface used by GraphicsView (Strategy interface).
+ *
+ * Primitives are drawn into a back buffer and only become visible when the
+ * buffer is presented. Implementations include an X11 window (Xwindow) and an
+ * in-memory framebuffer that writes each frame to disk (Framebuffer).
+ */
+class RenderBackend {
+   public:
+    /**
+     * @brief Available colours.
+     */
+    enum {
+        White = 0,
+        Black,
+        lRed,
+        dRed,
+        lGreen,
+        dGreen,
+        lBlue,
+        dBlue,
+        lPurple,
+        dPurple
+    };
+
+    /**
+     * @brief Virtual destructor for RenderBackend.
+     */
+    virtual ~RenderBackend() = default;
+
+    /**
+     * @brief Gets the width of the drawing surface in pixels.
+     * @return The width.
+     */
+    virtual int getWidth() const = 0;
+
+    /**
+     * @brief Gets the height of the drawing surface in pixels.
+     * @return The height.
+     */
+    virtual int getHeight() const = 0;
+
+    /**
+     * @brief Draws a filled rectangle to the buffer immediately.
+     */
+    virtual void fillRectangle(int x, int y, int width, int height,
+                               int colour = Black) = 0;
+
+    /**
+     * @brief Draws a string to the buffer with its baseline at y.
+     */
+    virtual void drawString(int x, int y, const std::string &msg) = 0;
+
+    /**
+     * @brief Draws a line to the buffer immediately.
+     */
+    virtual void drawLine(int x1, int y1, int x2, int y2, int thickness = 1,
+                          int colour = Black) = 0;
+
+    /**
+     * @brief Queues a filled rectangle for the next flushBatch.
+     */
+    virtual void queueRectangle(int x, int y, int width, int height,
+                                int colour = Black) = 0;
+
+    /**
+     * @brief Queues a line for the next flushBatch.
+     */
+    virtual void queueLine(int x1, int y1, int x2, int y2, int thickness = 1,
+                           int colour = Black) = 0;
+
+    /**
+     * @brief Draws all queued primitives to the buffer, rectangles before
+     * lines. Queued rectangles of different colours must not overlap.
+     */
+    virtual void flushBatch() = 0;
+
+    /**
+     * @brief Presents the whole buffer.
+     */
+    virtual void display() = 0;
+
+    /**
+     * @brief Marks a region of the buffer for presentation at the next flush.
+     */
+    virtual void displayArea(int x, int y, int width, int height) = 0;
+
+    /**
+     * @brief Ends the frame, presenting every region passed to displayArea.
+     */
+    virtual void flush() = 0;
+
+    /**
+     * @brief Checks if the backend is shown to a user and receives events.
+     *
+     * Interactive backends are driven by a render thread that coalesces
+     * frames; offscreen backends render every frame synchronously.
+     *
+     * @return True for interactive backends.
+     */
+    virtual bool isInteractive() const = 0;
+
+    /**
+     * @brief Gets a file descriptor that becomes readable when events arrive.
+     * @return The descriptor, or -1 if the backend has no events.
+     */
+    virtual int getConnectionFd() const { return -1; }
+
+    /**
+     * @brief Drains pending events.
+     * @return True if the presented image was lost and must be repainted.
+     */
+    virtual bool handleEvents() { return false; }
+};
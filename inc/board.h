@@ -1,10 +1,14 @@
 // board.h
 #pragma once
 
+#include <iosfwd>
 #include <memory>
+#include <memory_resource>
 #include <utility>
 #include <vector>
 
+#include "arena.h"
+
 class BaseCell;
 class Player;
 class Game;
@@ -17,18 +21,41 @@ class Game;
  * cells.
  */
 class Board {
-    std::vector<std::vector<std::unique_ptr<BaseCell>>>
-        board;     /**< 2D vector storing unique_ptr to BaseCell objects. */
+    std::pmr::memory_resource* arena; /**< Where cells are allocated. */
+    std::pmr::vector<std::pmr::vector<ArenaPtr<BaseCell>>>
+        board;     /**< 2D vector owning the BaseCell objects. */
     unsigned rows; /**< Number of rows on the board. */
     unsigned cols; /**< Number of columns on the board. */
 
+    /**
+     * @brief The squares a player's elimination has to clean up.
+     */
+    struct PlayerSquares {
+        Player* owner; /**< The player. */
+        std::pmr::vector<std::pair<int, int>>
+            owned; /**< Squares with one of the player's servers, goals or
+                      firewalls in some layer. */
+        std::pmr::vector<std::pair<int, int>>
+            vacated; /**< Where the player's links were when they left play;
+                        a link downloaded in place is still its square's
+                        occupant. */
+    };
+    std::pmr::vector<PlayerSquares>
+        squares; /**< One entry per player with anything on the board. */
+
+    /**
+     * @brief Gets a player's squares, adding an empty entry if needed.
+     */
+    PlayerSquares& squaresOf(Player* player);
+
    public:
     /**
      * @brief Constructor for the Board class.
      * @param row The number of rows for the board.
      * @param cols The number of columns for the board.
+     * @param arena Where to allocate cells; must outlive the board.
      */
-    Board(unsigned row, unsigned cols);
+    Board(unsigned row, unsigned cols, std::pmr::memory_resource* arena);
 
     /**
      * @brief Destructor for the Board class.
@@ -47,9 +74,9 @@ class Board {
 
     /**
      * @brief Gets a reference to the internal 2D vector representing the board.
-     * @return A reference to the board's 2D vector of unique_ptr to BaseCell.
+     * @return A reference to the board's 2D vector of BaseCell owners.
      */
-    std::vector<std::vector<std::unique_ptr<BaseCell>>>& getBoard();
+    std::pmr::vector<std::pmr::vector<ArenaPtr<BaseCell>>>& getBoard();
 
     /**
      * @brief Gets a reference to the cell at the specified coordinates.
@@ -67,22 +94,47 @@ class Board {
      * player-specific row allocation).
      * @param game A pointer to the Game instance.
      */
-    void placePlayerCells(const std::vector<std::pair<int, int>> placements,
+    void placePlayerCells(const std::vector<std::pair<int, int>>& placements,
                           Player* player, unsigned row, Game* game);
 
+    /**
+     * @brief Puts a player's firewall over a cell.
+     * @param coords Where; the caller checks that the cell can take it.
+     * @param owner The player placing it.
+     */
+    void addFirewall(std::pair<int, int> coords, Player* owner);
+
+    /**
+     * @brief Notes where a link was when it left play, so the square is
+     * checked if its owner is eliminated.
+     * @param owner The link's owner.
+     * @param coords The link's last coordinates.
+     */
+    void linkRemoved(Player* owner, std::pair<int, int> coords);
+
+    /**
+     * @brief Rebuilds the index of each player's squares by scanning every
+     * cell, after cells were replaced without going through the board.
+     */
+    void reindex();
+
     /**
      * @brief Removes all cells associated with a given player from the board,
-     * reverting them to BoardCells.
+     * reverting them to BoardCells, and takes the player's links off it.
+     *
+     * Only the player's own squares are visited: those with a layer they
+     * own, those holding their links and those their links left play from.
      * @param player A pointer to the Player whose cells are to be removed.
+     * @param game The game, for the positions of the player's links.
      */
-    void removePlayerCells(Player* player);
+    void removePlayerCells(Player* player, Game* game);
 
     /**
      * @brief Undecorates a cell, reverting it to its base form (e.g., from
      * Firewall to Server).
-     * @param cell A unique_ptr reference to the cell to be undecorated. The
-     * unique_ptr will be reset.
+     * @param cell A reference to the owner of the cell to be undecorated. It
+     * will be reset.
      * @param p A pointer to the Player who owns the cell.
      */
-    void undecorateCell(std::unique_ptr<BaseCell>& cell, Player* p);
+    void undecorateCell(ArenaPtr<BaseCell>& cell, Player* p);
 };
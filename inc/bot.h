@@ -0,0 +1,65 @@
+// bot.h
+#pragma once
+
+#include <sys/types.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief An external bot program run as a child process.
+ *
+ * The command is run with `/bin/sh -c`. The arbiter writes to the bot's
+ * standard input and reads lines from its standard output; standard error is
+ * shared with RAIInet.
+ */
+class BotProcess {
+    std::string command;     /**< The command line, for messages. */
+    pid_t pid = -1;          /**< The child process. */
+    int toBot = -1;          /**< Write end of the bot's standard input. */
+    int fromBot = -1;        /**< Read end of the bot's standard output. */
+    std::string partial;     /**< Output after the last complete line. */
+
+   public:
+    /**
+     * @brief Starts the bot.
+     * @param command The shell command that runs it.
+     * @throws std::runtime_error if the process cannot be started.
+     */
+    explicit BotProcess(std::string command);
+
+    /**
+     * @brief Closes the pipes and stops the bot if it is still running.
+     */
+    ~BotProcess();
+
+    BotProcess(const BotProcess &) = delete;
+    BotProcess &operator=(const BotProcess &) = delete;
+
+    /**
+     * @brief Gets the command that started the bot.
+     * @return The command line.
+     */
+    const std::string &getCommand() const;
+
+    /**
+     * @brief Gets the descriptor to watch for the bot's output.
+     * @return The read end of its standard output.
+     */
+    int getOutputFd() const;
+
+    /**
+     * @brief Writes to the bot's standard input. Writes to a bot that has
+     * exited are dropped; its output reaching end of file reports the exit.
+     * @param text The text to send.
+     */
+    void send(std::string_view text);
+
+    /**
+     * @brief Reads what the bot has written, once its descriptor is readable.
+     * @param lines Filled with the complete lines read, without newlines.
+     * @return False once the bot has closed its output.
+     */
+    bool receive(std::vector<std::string> &lines);
+};
@@ -5,6 +5,7 @@
 #include <optional>
 #include <string>
 
+#include "arena.h"
 #include "linkmanager.h"
 
 // Forward declarations to avoid circular includes
@@ -119,18 +120,16 @@ class BoardCell : public BaseCell {
  */
 class PlayerCell : public BaseCell {
    protected:
-    std::unique_ptr<BaseCell>
-        base;      /**< A unique_ptr to the BaseCell being decorated. */
+    ArenaPtr<BaseCell> base; /**< The BaseCell being decorated. */
     Player *owner; /**< A pointer to the Player who owns this cell. */
 
    public:
     /**
      * @brief Constructor for PlayerCell.
-     * @param base A unique_ptr to the BaseCell that this PlayerCell will
-     * decorate.
+     * @param base The BaseCell that this PlayerCell will decorate.
      * @param owner A pointer to the Player who owns this cell.
      */
-    PlayerCell(std::unique_ptr<BaseCell> base, Player *owner);
+    PlayerCell(ArenaPtr<BaseCell> base, Player *owner);
 
     /**
      * @brief Pure virtual destructor for PlayerCell.
@@ -161,6 +160,7 @@ class PlayerCell : public BaseCell {
     void emptyCell() override;
 
     friend class Board; /**< Board needs access to modify decorated cells. */
+    friend struct GameState; /**< GameState walks and rebuilds cell layers. */
 };
 
 /**
@@ -1,14 +1,66 @@
 // controller.h
 #pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "gamepool.h"
+#include "script.h"
+
 class Game;
 class View;
 class GraphicsView;
 class Player;
+class Tokenizer;
+class ReplayReader;
+class ReplayWriter;
+class EventLoop;
+class Timer;
+class BotProcess;
+class BotView;
+class StatePublisher;
+struct GameState;
+
+/**
+ * @brief Settings for one game, as given on the command line.
+ */
+struct GameConfig {
+    std::vector<std::string> abilities{"LFDPS",
+                                       "LFDPS"}; /**< Ability letters per
+                                                    player. */
+    std::vector<std::string> linkFiles{
+        "", ""}; /**< Link placement file per player; empty for random
+                    placements. */
+    std::optional<uint64_t> seed; /**< Seed for random placements; a random
+                                     one if unset. */
+    std::string recordPath;  /**< Replay file to record to, if any. */
+    unsigned keyframes = 64; /**< Turns between keyframes when recording. */
+    std::string replayPath;  /**< Replay file to start from, if any. */
+    std::optional<unsigned> seekTurn; /**< Turn to replay up to; the end if
+                                         unset. */
+    std::string loadPath;  /**< Save file to resume, if any. */
+    bool graphics = false; /**< Whether to show the graphical view. */
+    std::string framesDir; /**< Directory for offscreen frames; empty to use
+                              an X11 window. */
+    std::chrono::milliseconds turnTime{
+        0}; /**< Time allowed per turn; zero for no limit. */
+    std::vector<std::string> bots{
+        "", ""}; /**< Command running each player's bot; empty for a person
+                    at the terminal. */
+    std::string shmName; /**< Shared memory segment to publish the state
+                            to; empty to not publish. */
+    bool fileCommands = true; /**< Whether commands that name files (save,
+                                 load and sequence) may run; off for games
+                                 played by remote clients. */
+};
 
 /**
  * @brief The Controller handles user input and orchestrates the Model (Game)
@@ -19,11 +71,16 @@ class Player;
  * and ensuring that the views are updated accordingly.
  */
 class Controller {
-    std::unique_ptr<Game>
-        game; /**< A unique_ptr to the Game instance (the Model). */
+    std::ostream& out; /**< Where command responses and views are printed. */
+
+    GamePool::Handle game; /**< The Game instance (the Model), taken from
+                              the thread's GamePool. */
 
     std::unordered_map<Player*, std::vector<std::unique_ptr<View>>>
         views; /**< Map of Player pointers to their associated View objects. */
+    std::vector<std::ostream*>
+        seatOutputs; /**< Where each player's text view prints, by player;
+                        out where unset. */
 
     /**
      * @brief Reads link data from a specified file.
@@ -34,6 +91,18 @@ class Controller {
     void readLinkFile(std::string filename, std::vector<std::string>& linkList,
                       int placements);
 
+    uint64_t seed = 0; /**< Seed for random link placements. */
+    std::mt19937 rng;  /**< Source of random link placements. */
+    std::unique_ptr<ReplayReader>
+        replay; /**< The replay being resumed, if any. */
+    std::unique_ptr<ReplayWriter>
+        recorder; /**< Where actions are recorded, if enabled. */
+    std::unique_ptr<GameState>
+        saved; /**< Save file given with --load, until it is restored. */
+    std::unique_ptr<StatePublisher>
+        publisher; /**< Where the state is shared as the views are updated,
+                      if enabled. */
+
     /**
      * @brief Generates random link data.
      * @param linkList A vector of strings to populate with generated link data.
@@ -45,14 +114,188 @@ class Controller {
     bool gameIsRunning =
         false; /**< Flag indicating if the main game loop is active. */
 
-    bool usingGraphics;
-    std::unique_ptr<GraphicsView> graphicsView;
+    bool usingGraphics =
+        false; /**< Flag indicating if the graphical view is enabled. */
+    bool fileCommands = true; /**< Whether commands that name files may
+                                 run. */
+    std::string framesDir; /**< Directory for offscreen frames; empty to use
+                              an X11 window. */
+    std::unique_ptr<GraphicsView>
+        graphicsView; /**< The graphical view, if enabled. */
+
+    /**
+     * @brief An entry in the command dispatch table.
+     */
+    struct Command {
+        std::string_view name; /**< The command word. */
+        void (Controller::*handler)(Tokenizer&); /**< Runs the command with the
+                                                    rest of the line. */
+        bool namesFiles = false; /**< Whether it reads or writes a file the
+                                    player names. */
+    };
+
+    static constexpr std::size_t commandSlots =
+        16; /**< Size of the dispatch table; a power of two. */
+
+    /**
+     * @brief Hashes a command word into the dispatch table.
+     *
+     * The hash is perfect for the known commands, which is checked when the
+     * table is built at compile time.
+     * @param word The command word.
+     * @return The slot the word would occupy.
+     */
+    static constexpr std::size_t commandHash(std::string_view word) {
+        if (word.empty()) return 0;
+        return (word.size() + 3 * word.front() + 2 * word.back()) &
+               (commandSlots - 1);
+    }
+
+    /**
+     * @brief Builds the dispatch table; fails to compile if two commands
+     * share a slot.
+     * @return The table indexed by commandHash.
+     */
+    static constexpr std::array<Command, commandSlots> makeCommandTable();
+
+    static const std::array<Command, commandSlots>
+        commands; /**< Command words to handlers, indexed by commandHash. */
+
+    ScriptCache scripts; /**< Parsed sequence files. */
+    std::vector<std::string>
+        activeScripts; /**< Sequence files currently running, outermost
+                          first; used to reject include cycles. */
+
+    /**
+     * @brief Checks whether a sequence file is running, in which case
+     * graphical rendering waits until it finishes.
+     * @return True while inside a sequence.
+     */
+    bool inSequence() const;
+
+    std::unique_ptr<EventLoop>
+        loop; /**< Dispatches input and timers while the game runs. */
+
+    static constexpr std::size_t inputChunk =
+        1 << 16; /**< Bytes read from stdin at a time. */
+    std::vector<char> input; /**< Bytes read from stdin but not yet run. */
+    std::size_t inputFilled = 0; /**< Bytes of input in use. */
+
+    std::chrono::milliseconds turnTime{
+        0}; /**< Time allowed per turn; zero for no limit. */
+    std::unique_ptr<Timer>
+        turnClock;      /**< Expires when the current turn runs out. */
+    unsigned clockTurn; /**< Turn the clock was last started for. */
+    std::chrono::steady_clock::time_point
+        turnDeadline; /**< When the current turn runs out. */
+
+    /**
+     * @brief A player seat and the bot playing it, if any.
+     *
+     * The arbiter sends each bot its BotView deltas followed by one of:
+     * - `go [ms]`: reply with one `move` or `ability` command within the
+     *   time left for the turn, if there is a limit; a command that does not
+     *   end the turn, or is rejected, is followed by another `go`;
+     * - `ponder`: the opponent is to move, so the bot may think ahead;
+     * - `end win`, `end loss` or `end`: the game is over.
+     * A bot that runs out of time or exits loses.
+     */
+    struct Bot {
+        std::unique_ptr<BotProcess> process; /**< Null for a person. */
+        BotView* view = nullptr; /**< The bot's view, owned by views. */
+        bool toMove = false; /**< Sent `go` and waiting for a reply. */
+        unsigned ponderTurn =
+            ~0u; /**< Turn the bot was last told to ponder on. */
+    };
+    std::vector<Bot> bots; /**< Seats indexed by player. */
+    int winner = -1; /**< Index of the winner once known: the engine's
+                        winner, or the player left after a bot forfeits.
+                        Bots are told their result from this. */
+
+    /**
+     * @brief Reads what stdin has available and runs each complete line,
+     * updating the views once per read rather than once per line. Piped
+     * input is read in large blocks.
+     */
+    void onInput();
+
+    /**
+     * @brief Passes the turn to the next player when the turn clock expires,
+     * or ends the game if a bot ran out of time.
+     */
+    void onTurnTimeout();
+
+    /**
+     * @brief Runs the commands a bot has sent, if it is the bot's turn.
+     * @param player The bot's player index.
+     */
+    void onBotOutput(unsigned player);
+
+    /**
+     * @brief Brings the views, shared state, turn clock and bots up to date
+     * after input, and stops the loop once the game is over.
+     */
+    void settle();
+
+    /**
+     * @brief Checks whether any player is a bot.
+     * @return True in arbiter mode.
+     */
+    bool hasBots() const;
+
+    /**
+     * @brief Sends each bot its deltas and tells it whether to move or
+     * ponder, or that the game is over.
+     */
+    void promptBots();
+
+    /**
+     * @brief Ends the game in favour of the other player.
+     * @param player The index of the player whose bot failed.
+     * @param reason Why, e.g. "ran out of time".
+     */
+    void forfeit(unsigned player, std::string_view reason);
+
+    /**
+     * @brief Restarts the turn clock for the current turn, if there is one.
+     */
+    void armTurnClock();
+
+    /**
+     * @brief Announces the winner and stops the game once someone has won.
+     */
+    void checkGameOver();
+
+    /**
+     * @brief Publishes the current state to shared memory, if enabled.
+     */
+    void publishState();
+
+    // command handlers, each given the tokens after the command word
+    void quitCommand(Tokenizer& args);
+    void moveCommand(Tokenizer& args);
+    void abilitiesCommand(Tokenizer& args);
+    void abilityCommand(Tokenizer& args);
+    void boardCommand(Tokenizer& args);
+    void sequenceCommand(Tokenizer& args);
+    void commentCommand(Tokenizer& args);
+    void gupdateCommand(Tokenizer& args);
+    void saveCommand(Tokenizer& args);
+    void loadCommand(Tokenizer& args);
+    void statsCommand(Tokenizer& args);
+
+    /**
+     * @brief Replaces the text and bot views with fresh ones for the current
+     * players, which read their starting state from the game.
+     */
+    void buildViews();
 
    public:
     /**
      * @brief Constructor for the Controller.
+     * @param out Where to print command responses and views.
      */
-    Controller();
+    explicit Controller(std::ostream& out = std::cout);
 
     /**
      * @brief Destructor for the Controller.
@@ -61,15 +304,16 @@ class Controller {
 
     /**
      * @brief Starts and manages the main game loop, handling user input and
-     * turn progression.
+     * turn progression. The loop waits in epoll on stdin and the turn clock
+     * and ends on quit, a win or the end of input.
      */
     void runGameLoop();
 
     /**
      * @brief Parses and executes a given command line input from the user.
-     * @param commandLine The string containing the user's command.
+     * @param commandLine The user's command. Parsing does not copy it.
      */
-    void parseCommand(const std::string& commandLine);
+    void parseCommand(std::string_view commandLine);
 
     /**
      * @brief Initializes the game based on command-line arguments.
@@ -79,6 +323,43 @@ class Controller {
      */
     void init(int argc, char* argv[]);
 
+    /**
+     * @brief Sets up a game and its views and prints the first prompt,
+     * without reading any input.
+     * @param config The game's settings.
+     * @throws std::invalid_argument if a file named in the settings cannot
+     * be used.
+     */
+    void start(const GameConfig& config);
+
+    /**
+     * @brief Prints a player's text view to a stream of its own rather than
+     * the shared output, so the player's seat sees only its own board.
+     * Command responses still go to the shared output. Call before start().
+     * @param player The player's index.
+     * @param stream Where the player's board is printed; must outlive the
+     * Controller.
+     */
+    void setSeatOutput(unsigned player, std::ostream& stream);
+
+    /**
+     * @brief Checks whether the game is still being played.
+     * @return False once a player has won or quit.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Gets the game being played.
+     * @return The game; only valid after start().
+     */
+    const Game& getGame() const;
+
+    /**
+     * @brief Runs a line that may hold several commands separated by ';'.
+     * @param line The line to run.
+     */
+    void runCommands(std::string_view line);
+
     /**
      * @brief Notifies all registered views to update their display based on the
      * current game state.
@@ -86,7 +367,8 @@ class Controller {
     void updateViews();
 
     /**
-     * @brief Triggers the display of all active views.
+     * @brief Brings the views up to date and triggers the display of all
+     * active views.
      */
     void display();
 
@@ -0,0 +1,134 @@
+// eventloop.h
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A single-threaded epoll loop over file descriptors.
+ *
+ * Handlers run on the thread that called run(). Other threads hand work to
+ * the loop with post(), which wakes it through an eventfd. The loop sleeps in
+ * epoll_wait while nothing is ready, so it uses no CPU when idle.
+ */
+class EventLoop {
+    int epollFd; /**< The epoll instance. */
+    int wakeFd;  /**< eventfd signalled by post(). */
+    std::unordered_map<int, std::function<void()>>
+        handlers; /**< Callback for each watched descriptor. */
+    std::vector<int>
+        alwaysReady; /**< Descriptors epoll cannot watch, such as regular
+                        files, which never block and are polled every pass. */
+    std::mutex postedMutex;
+    std::vector<std::function<void()>>
+        posted; /**< Tasks from other threads, guarded by postedMutex. */
+    bool running = false; /**< Cleared by stop(). */
+
+    /**
+     * @brief Runs the tasks posted since the last call.
+     */
+    void runPosted();
+
+   public:
+    /**
+     * @brief Creates the epoll instance and the wakeup eventfd.
+     * @throws std::runtime_error if either cannot be created.
+     */
+    EventLoop();
+
+    /**
+     * @brief Closes the loop's descriptors. Watched descriptors are not
+     * closed.
+     */
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    /**
+     * @brief Calls a handler whenever a descriptor is readable or hung up.
+     * @param fd The descriptor to watch.
+     * @param onReady The handler; it should read what is available.
+     * @throws std::runtime_error if the descriptor cannot be watched.
+     */
+    void watch(int fd, std::function<void()> onReady);
+
+    /**
+     * @brief Stops watching a descriptor. Safe to call from its own handler.
+     * @param fd The descriptor.
+     */
+    void unwatch(int fd);
+
+    /**
+     * @brief Also calls a descriptor's handler when it becomes writable, or
+     * stops doing so. Used to finish writes that would have blocked.
+     * @param fd A watched descriptor.
+     * @param wantWrite Whether to wait for writability.
+     */
+    void setWritable(int fd, bool wantWrite);
+
+    /**
+     * @brief Queues a task to run on the loop's thread. Thread-safe.
+     * @param task The task.
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * @brief Dispatches events until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return after the current handler.
+     */
+    void stop();
+};
+
+/**
+ * @brief A one-shot timer backed by a timerfd, for use with EventLoop.
+ */
+class Timer {
+    int fd; /**< The timerfd. */
+
+   public:
+    /**
+     * @brief Creates a disarmed timer.
+     * @throws std::runtime_error if the timerfd cannot be created.
+     */
+    Timer();
+
+    /**
+     * @brief Closes the timerfd.
+     */
+    ~Timer();
+
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+
+    /**
+     * @brief Gets the descriptor, readable once the timer expires.
+     * @return The timerfd.
+     */
+    int getFd() const;
+
+    /**
+     * @brief Starts the timer, replacing any earlier deadline.
+     * @param delay Time until expiry; must be positive.
+     */
+    void arm(std::chrono::milliseconds delay);
+
+    /**
+     * @brief Cancels the timer and discards an expiry not yet consumed.
+     */
+    void disarm();
+
+    /**
+     * @brief Acknowledges an expiry.
+     * @return True if the timer had expired; false if it was re-armed or
+     * disarmed after becoming readable.
+     */
+    bool consume();
+};
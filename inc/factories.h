@@ -1,9 +1,12 @@
 // factories.h
 #pragma once
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <utility>
 
+#include "arena.h"
+
 class Ability;
 class Link;
 class Player;
@@ -18,11 +21,13 @@ class Board;
 class AbilityFactory {
    public:
     /**
-     * @brief Creates a unique_ptr to an Ability object based on a character ID.
+     * @brief Creates an Ability object based on a character ID.
      * @param id The character ID representing the type of ability to create.
-     * @return A unique_ptr to the newly created Ability object.
+     * @param arena Where to allocate the ability.
+     * @return The newly created Ability object.
      */
-    static std::unique_ptr<Ability> createPlayerAbility(char id);
+    static ArenaPtr<Ability> createPlayerAbility(
+        char id, std::pmr::memory_resource* arena);
 };
 
 /**
@@ -34,14 +39,16 @@ class AbilityFactory {
 class LinkFactory {
    public:
     /**
-     * @brief Creates a unique_ptr to a Link object with specified properties.
+     * @brief Creates a Link object with specified properties.
      * @param id The string ID representing the type of link (e.g., "v1", "d2").
      * @param startCoords The initial coordinates (row, column) of the link.
      * @param owner A pointer to the Player who owns this link.
      * @param board A pointer to the game Board where the link will be placed.
-     * @return A unique_ptr to the newly created Link object.
+     * @param arena Where to allocate the link.
+     * @return The newly created Link object.
      */
-    static std::unique_ptr<Link> createLink(std::string id,
-                                            std::pair<int, int> startCoords,
-                                            Player* owner, Board* board);
+    static ArenaPtr<Link> createLink(std::string id,
+                                     std::pair<int, int> startCoords,
+                                     Player* owner, Board* board,
+                                     std::pmr::memory_resource* arena);
 };
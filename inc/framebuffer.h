@@ -0,0 +1,87 @@
+// framebuffer.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "backend.h"
+
+/**
+ * @brief In-memory software rasterizer implementing RenderBackend.
+ *
+ * Pixels are kept as 0xRRGGBB values. Each presented frame is optionally
+ * written as a binary PPM image named `frame_NNNNNN.ppm` in an output
+ * directory, which allows rendering without an X server.
+ */
+class Framebuffer : public RenderBackend {
+    int width;
+    int height;
+    std::vector<uint32_t> pixels; /**< Row-major pixel buffer. */
+    std::string outputDir; /**< Directory frames are written to; empty to keep
+                              frames in memory only. */
+    unsigned frameCount = 0; /**< Number of frames presented so far. */
+    bool framePending = false; /**< Whether anything was presented since the
+                                  last flush. */
+
+    struct QueuedRect {
+        int x, y, width, height, colour;
+    };
+    struct QueuedLine {
+        int x1, y1, x2, y2, thickness, colour;
+    };
+    std::vector<QueuedRect> rectQueue;
+    std::vector<QueuedLine> lineQueue;
+
+    /**
+     * @brief Writes the current buffer as the next frame, if writing is on.
+     */
+    void writeFrame();
+
+   public:
+    /**
+     * @brief Constructor for Framebuffer.
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     * @param outputDir Directory to write PPM frames to, or empty for none.
+     */
+    Framebuffer(int width, int height, std::string outputDir = "");
+
+    int getWidth() const override;
+    int getHeight() const override;
+
+    void fillRectangle(int x, int y, int width, int height,
+                       int colour = Black) override;
+    void drawString(int x, int y, const std::string &msg) override;
+    void drawLine(int x1, int y1, int x2, int y2, int thickness = 1,
+                  int colour = Black) override;
+    void queueRectangle(int x, int y, int width, int height,
+                        int colour = Black) override;
+    void queueLine(int x1, int y1, int x2, int y2, int thickness = 1,
+                   int colour = Black) override;
+    void flushBatch() override;
+
+    void display() override;
+    void displayArea(int x, int y, int width, int height) override;
+    void flush() override;
+
+    bool isInteractive() const override;
+
+    /**
+     * @brief Gets the number of frames presented so far.
+     * @return The frame count.
+     */
+    unsigned getFrameCount() const;
+
+    /**
+     * @brief Gets the pixel buffer.
+     * @return A const reference to the row-major 0xRRGGBB pixels.
+     */
+    const std::vector<uint32_t> &getPixels() const;
+
+    /**
+     * @brief Writes the buffer as a binary PPM (P6) image.
+     * @param filename The file to write.
+     */
+    void writePPM(const std::string &filename) const;
+};
@@ -1,18 +1,25 @@
 // game.h
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <queue>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include "arena.h"
 #include "link.h"
 #include "views.h"
 
 class Player;
 class LinkManager;
 class Board;
+struct AbilityArgs;
 
 /**
  * @brief Manages the overall game state, players, and turn logic (the Model in
@@ -34,20 +41,81 @@ class Game {
                          View::RevealLinkUpdate, View::ScoreUpdate>
         update_type;
 
-    std::vector<std::unique_ptr<Player>>
-        players; /**< Vector of unique_ptr to Player objects participating in
-                    the game. */
+    static constexpr std::size_t arenaBytes =
+        16 * 1024; /**< Space inside the Game for the arena; enough for a
+                      two player game and the decorators its abilities add. */
+    alignas(std::max_align_t) std::byte
+        arenaBuffer[arenaBytes]; /**< Backs the arena until it is used up. */
+    CountingResource arenaOverflow; /**< Where the arena gets more memory
+                                       once its buffer is used up. */
+    std::pmr::monotonic_buffer_resource arena{
+        arenaBuffer, arenaBytes,
+        &arenaOverflow}; /**< Where the board, cells, links, players and
+                            abilities are allocated. Freeing is a no-op; the
+                            memory goes back all at once when the game is
+                            reset, restored or destroyed. Declared before
+                            everything allocated from it. */
+
+    std::pmr::vector<ArenaPtr<Player>> players{
+        &arena}; /**< The players participating in the game; null once a
+                    player is eliminated. */
     int currentPlayerIndex; /**< Index of the currently active player in the
                                `players` vector. */
-    std::unique_ptr<Board>
-        board; /**< A unique_ptr to the game Board instance. */
-    std::shared_ptr<LinkManager>
-        linkManager; /**< A shared_ptr to the LinkManager instance, managing all
-                        links. */
+    ArenaPtr<Board> board; /**< The game Board instance. */
+    ArenaPtr<LinkManager>
+        linkManager; /**< The LinkManager instance, managing all links. */
     std::queue<update_type> queue; /**< A queue of update_type variants for view
                                       updates (Observer pattern). */
+    std::pmr::vector<unsigned> knowledge{
+        &arena}; /**< Knowledge matrix: for each observing player index, a
+                    bitmask of the links whose type and strength they know.
+                    Bit `owner * 8 + linkId` is set once revealed. */
+    std::pmr::vector<std::pair<Link::LinkType, int>> identities{
+        &arena}; /**< Type and strength of every link, indexed by
+                    `owner * 8 + linkId`, as of its last published value;
+                    kept after the link leaves the board. */
+    std::pmr::vector<std::pmr::string> loadouts{
+        &arena}; /**< Ability letters each player started with. */
+    unsigned turn = 0; /**< Number of turns completed. */
+    std::pmr::vector<uint8_t> linksLeft{
+        &arena}; /**< Links each player still has, by player index. */
+    unsigned alivePlayers = 0; /**< Players not yet eliminated. */
+    unsigned losing = 0; /**< Bit i is set while player i has downloaded too
+                            many viruses or has no links left; nobody is
+                            eliminated while this is 0. */
+    Player* winner = nullptr; /**< Set as soon as a score or an elimination
+                                 decides the game. */
+    std::ostream *out; /**< Where game messages are printed. */
+
+    /**
+     * @brief Recounts links, players and losses from scratch, after the game
+     * is set up or restored.
+     */
+    void recount();
+
+    /**
+     * @brief Works out who, if anyone, has won; called whenever a threshold
+     * is crossed.
+     */
+    void decideWinner();
+
+    /**
+     * @brief Destroys every cell, link, player and ability and rewinds the
+     * arena, leaving no board, link manager or players to be rebuilt by
+     * startGame() or GameState::restore(). Queued view updates are
+     * discarded.
+     */
+    void clear();
 
    public:
+    static constexpr int winningData = 4;   /**< Data downloads that win. */
+    static constexpr int losingViruses = 4; /**< Virus downloads that lose. */
+    static constexpr unsigned maxPlayers = 4; /**< Most players in a game;
+                                                 link ids name four players'
+                                                 links. */
+    static_assert(maxPlayers * 8 <= std::numeric_limits<unsigned>::digits,
+                  "a knowledge row needs a bit for every link in the game");
+
     /**
      * @brief Constructor for the Game class.
      */
@@ -58,6 +126,12 @@ class Game {
      */
     ~Game();
 
+    /**
+     * @brief Sets where game messages are printed; standard output by default.
+     * @param stream The stream, which must outlive the game.
+     */
+    void setOutput(std::ostream& stream);
+
     /**
      * @brief Initializes and starts a new game with the specified number of
      * players, abilities, and link placements.
@@ -70,11 +144,32 @@ class Game {
     void startGame(unsigned nPlayers, const std::vector<std::string>& abilities,
                    const std::vector<std::vector<std::string>>& linkPlacements);
 
+    /**
+     * @brief Starts a new game in place of this one, reusing its storage.
+     *
+     * Every cell, link, player and ability of the current game is destroyed
+     * and the arena is rewound to the start of its buffer before the new
+     * game is set up, so a game that is reset repeatedly allocates nothing.
+     * References into the old game are invalid afterwards, and queued view
+     * updates are discarded.
+     * @param nPlayers The number of players in the game.
+     * @param abilities Each player's ability letters.
+     * @param linkPlacements Each player's link placements.
+     */
+    void reset(unsigned nPlayers, const std::vector<std::string>& abilities,
+               const std::vector<std::vector<std::string>>& linkPlacements);
+
     /**
      * @brief Advances the game to the next player's turn.
      */
     void nextTurn();
 
+    /**
+     * @brief Gets the number of turns completed so far.
+     * @return The turn count; 0 before the first move.
+     */
+    unsigned getTurn() const;
+
     /**
      * @brief Gets a reference to the game board.
      * @return A reference to the Board instance.
@@ -82,17 +177,33 @@ class Game {
     Board& getBoard() const;
 
     /**
-     * @brief Cleans up players who have lost all their links, effectively
-     * removing them from the game.
+     * @brief Eliminates players who have downloaded too many viruses or have
+     * lost all their links. Does nothing unless a score or a removed link
+     * has crossed one of those thresholds.
      */
     void cleanPlayers();
 
     /**
-     * @brief Checks for win/loss conditions in the game.
+     * @brief Checks for win/loss conditions in the game. The winner is
+     * decided when a threshold is crossed, so this only reads it.
      * @return A pointer to the winning Player, or nullptr if no player has won
      * yet.
      */
-    Player* checkWinLoss();
+    Player* checkWinLoss() const;
+
+    /**
+     * @brief Notes that a player's score changed, deciding the game or
+     * marking the player as losing if it crossed a threshold.
+     * @param player The player.
+     */
+    void scoreChanged(const Player& player);
+
+    /**
+     * @brief Notes that a link left the board.
+     * @param key The link.
+     * @param coords Where it was last.
+     */
+    void linkRemoved(LinkManager::LinkKey key, std::pair<int, int> coords);
 
     /**
      * @brief Gets a pointer to the currently active player.
@@ -100,6 +211,12 @@ class Game {
      */
     Player* getCurrentPlayer();
 
+    /**
+     * @brief Gets the index of the currently active player.
+     * @return The index into getPlayers().
+     */
+    unsigned getCurrentPlayerIndex() const;
+
     /**
      * @brief Gets a vector of pointers to all players in the game.
      * @return A vector of Player pointers.
@@ -113,6 +230,20 @@ class Game {
      */
     unsigned getPlayerIndex(const Player& player) const;
 
+    /**
+     * @brief Gets the arena the game's objects are allocated from, for
+     * abilities that add decorators.
+     * @return The game's memory resource; valid while the game lives.
+     */
+    std::pmr::memory_resource* getArena();
+
+    /**
+     * @brief Gets how much memory the arena has taken from the heap beyond
+     * its buffer inside the Game.
+     * @return The bytes held.
+     */
+    std::size_t getArenaOverflow() const;
+
     /**
      * @brief Gets a reference to the LinkManager instance.
      * @return A reference to the LinkManager.
@@ -137,8 +268,51 @@ class Game {
      */
     std::queue<update_type> flushUpdates();
 
+    /**
+     * @brief Records that a player has learned the identity of a link.
+     *
+     * Sets the observer's bit in the knowledge matrix and, if it was not
+     * already set, queues a RevealLinkUpdate for the views.
+     *
+     * @param key The LinkKey of the revealed link.
+     * @param observer The Player who now knows the link's type and strength.
+     */
+    void revealLink(LinkManager::LinkKey key, const Player& observer);
+
+    /**
+     * @brief Records that every player has learned the identity of a link.
+     * @param key The LinkKey of the revealed link.
+     */
+    void revealLinkToAll(LinkManager::LinkKey key);
+
+    /**
+     * @brief Checks whether a player knows the identity of a link.
+     * @param observer The index of the observing player.
+     * @param playerId The index of the player who owns the link.
+     * @param linkId The ID of the link within its owner's links.
+     * @return True if the observer may see the link's type and strength.
+     */
+    bool isRevealedTo(unsigned observer, unsigned playerId,
+                      unsigned linkId) const;
+
+    /**
+     * @brief Gets an observer's row of the knowledge matrix.
+     * @param observer The index of the observing player.
+     * @return A bitmask with bit `owner * 8 + linkId` set for every known link.
+     */
+    unsigned getRevealMask(unsigned observer) const;
+
+    /**
+     * @brief Builds a RevealLinkUpdate carrying a link's current value and
+     * remembers that value as the link's identity.
+     * @param key The LinkKey of the link.
+     * @return A RevealLinkUpdate for the link (e.g. value "V3").
+     */
+    View::RevealLinkUpdate getRevealUpdate(LinkManager::LinkKey key);
+
     /**
      * @brief Retrieves the LinkType and strength of a specific player's link.
+     * Links that have left the board report their last published value.
      * @param playerId The ID of the player.
      * @param linkId The ID of the link owned by the player.
      * @return A pair where the first element is the LinkType and the second is
@@ -151,22 +325,26 @@ class Game {
      * @brief Executes a movement action for a specified link in a given
      * direction.
      * @param link The ID of the link to move.
-     * @param dir The character representing the direction of movement ('N',
-     * 'S', 'E', 'W').
+     * @param dir The direction of movement.
+     * @throws std::exception if the move is not legal; the turn does not
+     * advance.
      */
-    void makeMove(unsigned link, char dir);
+    void makeMove(unsigned link, Link::Direction dir);
 
     /**
-     * @brief Activates a player's ability.
-     * @param id The ID of the ability to use.
-     * @param params A vector of strings containing any parameters required for
-     * the ability.
+     * @brief Activates one of the current player's abilities.
+     * @param id The 1-based ID of the ability to use.
+     * @param args The parsed arguments for the ability.
+     * @throws std::exception if the ID or the arguments are invalid.
      */
-    void useAbility(int id, const std::vector<std::string>& params);
+    void useAbility(int id, const AbilityArgs& args);
 
     /**
      * @brief Prints current game information (e.g., player scores, active
      * links) for debugging or status display.
      */
     void printGameInfo();
+
+    friend struct GameState; /**< GameState captures and restores the whole
+                                model. */
 };
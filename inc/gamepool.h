@@ -0,0 +1,82 @@
+// gamepool.h
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class Game;
+
+/**
+ * @brief Keeps finished games for reuse, one pool per thread.
+ *
+ * A Game carries its arena inline, so making one is a large allocation and
+ * starting one fills the arena from scratch. Games taken from the pool are
+ * handed back when their handle is destroyed and go to the pool of the
+ * thread that destroys them; the next acquire() on that thread reuses one
+ * with Game::reset() instead of allocating. Server workers each get their
+ * own pool without locking.
+ */
+class GamePool {
+    std::vector<std::unique_ptr<Game>> idle; /**< Games ready for reuse. */
+    std::size_t capacity; /**< Most idle games kept; extras are freed. */
+
+   public:
+    /**
+     * @brief Returns a game to the current thread's pool.
+     */
+    struct Return {
+        /**
+         * @brief Hands a game back to the pool.
+         * @param game The game, which must have come from acquire().
+         */
+        void operator()(Game* game) const;
+    };
+
+    /**
+     * @brief Owns a game from the pool and returns it when destroyed.
+     */
+    using Handle = std::unique_ptr<Game, Return>;
+
+    /**
+     * @brief Creates an empty pool.
+     * @param capacity Most idle games to keep.
+     */
+    explicit GamePool(std::size_t capacity = 64);
+
+    /**
+     * @brief Frees the idle games.
+     */
+    ~GamePool();
+
+    GamePool(const GamePool&) = delete;
+    GamePool& operator=(const GamePool&) = delete;
+
+    /**
+     * @brief Gets the calling thread's pool.
+     * @return The pool, created on first use and freed when the thread
+     * exits.
+     */
+    static GamePool& local();
+
+    /**
+     * @brief Takes an idle game, or makes a new one if there are none.
+     *
+     * The game may still hold a finished game; start it with Game::reset(),
+     * which works on new games too.
+     * @return The game.
+     */
+    Handle acquire();
+
+    /**
+     * @brief Keeps a game for reuse, or frees it if the pool is full.
+     * @param game The game to take back.
+     */
+    void release(Game* game);
+
+    /**
+     * @brief Gets the number of games ready for reuse.
+     * @return The number of idle games.
+     */
+    std::size_t size() const;
+};
@@ -0,0 +1,157 @@
+// gamestate.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+class Game;
+
+/**
+ * @brief A fixed-layout snapshot of everything that determines how a game
+ * plays out.
+ *
+ * The struct is trivially copyable and contains no pointers, so it can be
+ * written to disk as raw bytes and read back on the same platform. Links and
+ * cells are stored as their decorator chains, outermost layer first.
+ * Entangled links refer to their partner by owner, link id and the layer of
+ * the partner's chain they point at, counted from the base link.
+ */
+struct GameState {
+    static constexpr unsigned maxPlayers = 4;     /**< Most players stored. */
+    static constexpr unsigned linksPerPlayer = 8; /**< Links each player has. */
+    static constexpr unsigned maxAbilities = 5;   /**< Abilities per player. */
+    static constexpr unsigned rows = 10;          /**< Board rows. */
+    static constexpr unsigned cols = 8;           /**< Board columns. */
+    static constexpr unsigned maxLinkLayers = 8;  /**< Decorators per link. */
+    static constexpr unsigned maxCellLayers = 4;  /**< Decorators per cell. */
+    static constexpr uint8_t none = 0xFF; /**< Marks an absent player or
+                                             link reference. */
+
+    /**
+     * @brief Kinds of link decorator.
+     */
+    enum LinkLayer : uint8_t {
+        Boost = 1,
+        Polarize,
+        Entangle = 4 /**< 3 was a reveal layer; who has seen a link is now
+                        kept in the knowledge rows. */
+    };
+
+    /**
+     * @brief Kinds of cell decorator.
+     */
+    enum CellLayer : uint8_t { Server = 1, Firewall, Goal };
+
+    /**
+     * @brief A reference to one layer of a link's decorator chain.
+     */
+    struct LinkRef {
+        uint8_t player; /**< Owner index, or none. */
+        uint8_t id;     /**< Link id within the owner's links. */
+        uint8_t depth;  /**< Layer of the chain; 0 is the base link. */
+    };
+
+    /**
+     * @brief One link and its decorators.
+     */
+    struct LinkState {
+        uint8_t present;  /**< Whether the link is still in play. */
+        uint8_t isData;   /**< Type of the base link; for a link no longer
+                             in play, its last published type. */
+        uint8_t strength; /**< Strength of the base link, or the last
+                             published strength. */
+        uint8_t layerCount;
+        int8_t row;
+        int8_t col;
+        uint8_t layers[maxLinkLayers];   /**< LinkLayer values. */
+        LinkRef partners[maxLinkLayers]; /**< Partner of each Entangle
+                                            layer. */
+    };
+
+    /**
+     * @brief One board cell, its decorators and its occupant.
+     */
+    struct CellState {
+        uint8_t layerCount;
+        uint8_t layers[maxCellLayers]; /**< CellLayer values. */
+        uint8_t owners[maxCellLayers]; /**< Owner index of each layer. */
+        uint8_t occupantPlayer;        /**< Occupant's owner, or none. */
+        uint8_t occupantId;
+    };
+
+    /**
+     * @brief One player's score, abilities and links.
+     */
+    struct PlayerState {
+        uint8_t alive;
+        uint8_t abilityCount;
+        char abilities[maxAbilities]; /**< Ability letters, as on the command
+                                         line. */
+        uint8_t usedMask;             /**< Bit i set if ability i is used. */
+        int32_t abilitiesUsed;
+        int32_t data;    /**< Data links downloaded. */
+        int32_t viruses; /**< Viruses downloaded. */
+        LinkState links[linksPerPlayer];
+    };
+
+    uint32_t turn;
+    uint8_t playerCount;
+    uint8_t currentPlayer;
+    uint32_t knowledge[maxPlayers]; /**< Rows of the knowledge matrix. */
+    static_assert(maxPlayers * linksPerPlayer <= 32,
+                  "a stored knowledge row needs a bit for every link");
+    PlayerState players[maxPlayers];
+    CellState cells[rows][cols];
+
+    /**
+     * @brief Takes a snapshot of a running game.
+     * @param game The game to capture.
+     * @return The snapshot.
+     * @throws std::length_error if the game does not fit the fixed layout.
+     */
+    static GameState capture(const Game &game);
+
+    /**
+     * @brief Takes a snapshot of a running game into an existing state,
+     * allocating nothing, so it can run after every turn.
+     * @param game The game to capture.
+     * @param state Overwritten with the snapshot.
+     * @throws std::length_error if the game does not fit the fixed layout;
+     * the state is then incomplete.
+     */
+    static void capture(const Game &game, GameState &state);
+
+    /**
+     * @brief Puts a game into this state.
+     *
+     * The game must have been started with the same number of players. No
+     * view updates are queued; views should be rebuilt afterwards.
+     * @param game The game to overwrite.
+     * @throws std::invalid_argument if the snapshot does not fit the game.
+     */
+    void restore(Game &game) const;
+
+    /**
+     * @brief Writes the snapshot to a save file.
+     *
+     * The file is a small versioned header followed by the raw struct. It is
+     * written beside the destination and renamed into place, so an existing
+     * save is never left half written.
+     * @param path Where to save.
+     * @throws std::invalid_argument if the file cannot be written.
+     */
+    void save(const std::string &path) const;
+
+    /**
+     * @brief Reads a snapshot from a save file.
+     * @param path The file to read.
+     * @return The snapshot.
+     * @throws std::invalid_argument if the file is missing, was written by
+     * another version or build, or is malformed.
+     */
+    static GameState load(const std::string &path);
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>,
+              "GameState is written to disk as raw bytes");
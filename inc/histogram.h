@@ -0,0 +1,75 @@
+// histogram.h
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Counts values in log-linear buckets, in the style of an HDR
+ * histogram.
+ *
+ * Values below 16 get a bucket each; above that, every power of two is split
+ * into 16 buckets, so a reported value is within 1/16 of the true one. The
+ * size is fixed however many values are recorded. Recording is lock-free and
+ * may happen on several threads at once.
+ */
+class Histogram {
+    static constexpr unsigned subBits = 4; /**< Precision in bits. */
+    static constexpr unsigned subBuckets = 1u << subBits;
+    static constexpr unsigned buckets =
+        (64 - subBits + 1) * subBuckets; /**< Enough for any uint64_t. */
+
+    std::array<std::atomic<uint64_t>, buckets>
+        counts{}; /**< Values recorded in each bucket. */
+    std::atomic<uint64_t> total{0};   /**< Values recorded. */
+    std::atomic<uint64_t> largest{0}; /**< Largest value recorded. */
+
+    /**
+     * @brief Finds the bucket a value falls in.
+     * @param value The value.
+     * @return The bucket's index.
+     */
+    static unsigned bucketOf(uint64_t value);
+
+    /**
+     * @brief Finds the largest value that falls in a bucket.
+     * @param bucket The bucket's index.
+     * @return The value.
+     */
+    static uint64_t highestIn(unsigned bucket);
+
+   public:
+    /**
+     * @brief Records a value.
+     * @param value The value.
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief Adds every value recorded in another histogram.
+     * @param other The histogram to add.
+     */
+    void merge(const Histogram& other);
+
+    /**
+     * @brief Gets the number of values recorded.
+     * @return The count.
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Gets the largest value recorded.
+     * @return The value, or 0 if there are none.
+     */
+    uint64_t max() const;
+
+    /**
+     * @brief Estimates a percentile.
+     * @param quantile The fraction of values at or below the result, from 0
+     * to 1.
+     * @return The largest value in the bucket holding that percentile,
+     * capped at max(), or 0 if there are no values.
+     */
+    uint64_t percentile(double quantile) const;
+};
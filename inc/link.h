@@ -4,6 +4,8 @@
 #include <memory>
 #include <utility>  // For std::pair
 
+#include "arena.h"
+
 class Player;
 class Board;
 class Game;
@@ -69,12 +71,6 @@ class Link {
      */
     virtual LinkType getType() const = 0;
 
-    /**
-     * @brief Checks if the link is revealed to opponents.
-     * @return True if the link is revealed, false otherwise.
-     */
-    virtual bool getRevealState() const;
-
     /**
      * @brief Gets the current coordinates of the link.
      * @return A pair of integers representing the (row, column) coordinates.
@@ -184,27 +180,26 @@ class DataLink : public Link {
  */
 class LinkDecorator : public Link {
    protected:
-    std::unique_ptr<Link>
-        base; /**< A unique_ptr to the Link object being decorated. */
+    ArenaPtr<Link> base; /**< The Link object being decorated. */
 
    public:
     /**
      * @brief Constructor for LinkDecorator.
-     * @param base A unique_ptr to the Link to be decorated.
+     * @param base The Link to be decorated.
      */
-    LinkDecorator(std::unique_ptr<Link> base);
+    LinkDecorator(ArenaPtr<Link> base);
 
     /**
-     * @brief Delegates to the base link to get its type.
-     * @return The LinkType of the base link.
+     * @brief Gets the link this decorator wraps.
+     * @return A pointer to the next link in the decorator chain.
      */
-    LinkType getType() const override;
+    Link* getBase() const;
 
     /**
-     * @brief Delegates to the base link to get its reveal state.
-     * @return True if the base link is revealed, false otherwise.
+     * @brief Delegates to the base link to get its type.
+     * @return The LinkType of the base link.
      */
-    bool getRevealState() const override;
+    LinkType getType() const override;
 
     /**
      * @brief Delegates to the base link to get its coordinates.
@@ -279,24 +274,6 @@ class PolarizeDecorator : public LinkDecorator {
     LinkType getType() const override;
 };
 
-/**
- * @brief Decorator that makes a link visible to opponents.
- *
- * This decorator changes the `getRevealState` behavior to always return true,
- * effectively making the decorated link visible on views that respect this
- * state.
- */
-class RevealDecorator : public LinkDecorator {
-   public:
-    using LinkDecorator::LinkDecorator;  // Inherit constructors
-
-    /**
-     * @brief Returns true, indicating the decorated link is revealed.
-     * @return True.
-     */
-    bool getRevealState() const override;
-};
-
 /**
  * @brief Decorator that delays or restricts link movement for a certain number
  * of turns.
@@ -331,11 +308,23 @@ class QuantumEntanglementDecorator : public LinkDecorator {
    public:
     /**
      * @brief Constructor for QuantumEntanglementDecorator.
-     * @param base A unique_ptr to the Link being decorated.
+     * @param base The Link being decorated.
      * @param partner A pointer to the partner Link that will move together with
      * the base link.
      */
-    QuantumEntanglementDecorator(std::unique_ptr<Link> base, Link* partner);
+    QuantumEntanglementDecorator(ArenaPtr<Link> base, Link* partner);
+
+    /**
+     * @brief Gets the link this one is entangled with.
+     * @return A pointer to the partner link, or nullptr if it has none.
+     */
+    Link* getPartner() const;
+
+    /**
+     * @brief Entangles this link with a different partner.
+     * @param newPartner The new partner link; may be nullptr.
+     */
+    void setPartner(Link* newPartner);
 
     /**
      * @brief Moves both the base link and its entangled partner in the
@@ -3,9 +3,12 @@
 #include <functional>  // For std::function
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
+#include "arena.h"
+
 class Player;
 class Link;
 class Board;
@@ -18,8 +21,9 @@ class Board;
  * links, indexed by their owner and a unique ID.
  */
 class LinkManager {
-    std::map<Player*, std::vector<std::unique_ptr<Link>>>
-        linkMap; /**< Map from Player* to a vector of unique_ptr<Link>, storing
+    std::pmr::memory_resource* arena; /**< Where links are allocated. */
+    std::pmr::map<Player*, std::pmr::vector<ArenaPtr<Link>>>
+        linkMap; /**< Map from Player* to a vector of owned links, storing
                     each player's links. */
 
    public:
@@ -48,8 +52,9 @@ class LinkManager {
 
     /**
      * @brief Constructor for LinkManager.
+     * @param arena Where to allocate links; must outlive the manager.
      */
-    LinkManager();
+    explicit LinkManager(std::pmr::memory_resource* arena);
 
     /**
      * @brief Adds a set of links for a given player.
@@ -104,17 +109,19 @@ class LinkManager {
     /**
      * @brief Applies a decorator function to a specific link.
      *
-     * This function takes a `std::function` that transforms a
-     * `unique_ptr<Link>` into another `unique_ptr<Link>` (the decorated
+     * This function takes a `std::function` that transforms an
+     * `ArenaPtr<Link>` into another `ArenaPtr<Link>` (the decorated
      * version) and applies it to the link identified by `key`.
      *
      * @param key The LinkKey of the link to decorate.
-     * @param decorator A `std::function` that takes a `unique_ptr<Link>` and
-     * returns a `unique_ptr<Link>` (the decorated link).
+     * @param decorator A `std::function` that takes an `ArenaPtr<Link>` and
+     * returns an `ArenaPtr<Link>` (the decorated link).
      * @return True if the decorator was successfully applied, false if the link
      * was not found.
      */
     bool applyDecorator(
         LinkKey key,
-        std::function<std::unique_ptr<Link>(std::unique_ptr<Link>)>& decorator);
+        std::function<ArenaPtr<Link>(ArenaPtr<Link>)>& decorator);
+
+    friend struct GameState; /**< GameState captures and rebuilds links. */
 };
@@ -0,0 +1,207 @@
+// log.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief How much a log message matters, least first.
+ */
+enum class LogLevel : uint8_t {
+    Debug,   /**< Engine internals, for tracking down bugs. */
+    Info,    /**< Progress of a game, such as whose turn it is. */
+    Warning, /**< Something went wrong but play goes on. */
+    Error,   /**< Something failed. */
+    Off      /**< Filters out every message; not a level to log at. */
+};
+
+/**
+ * @brief Where log messages go.
+ *
+ * Writes are serialized by Log, so a sink need not be thread-safe.
+ */
+class LogSink {
+   public:
+    virtual ~LogSink() = default;
+
+    /**
+     * @brief Records a message.
+     * @param level The message's level.
+     * @param message The message, without a trailing newline.
+     */
+    virtual void write(LogLevel level, std::string_view message) = 0;
+};
+
+/**
+ * @brief Writes messages to a stream, one per line, prefixed by their level.
+ */
+class StreamSink : public LogSink {
+    std::ostream& out; /**< Where messages are written. */
+
+   public:
+    /**
+     * @param out The stream, which must outlive the sink.
+     */
+    explicit StreamSink(std::ostream& out);
+
+    void write(LogLevel level, std::string_view message) override;
+};
+
+/**
+ * @brief Writes messages to a file, as StreamSink does.
+ */
+class FileSink : public LogSink {
+    std::ofstream file; /**< The open file. */
+    StreamSink lines;   /**< Formats lines into the file. */
+
+   public:
+    /**
+     * @param path The file, which is truncated.
+     * @throws std::runtime_error If it cannot be opened.
+     */
+    explicit FileSink(const std::string& path);
+
+    void write(LogLevel level, std::string_view message) override;
+};
+
+/**
+ * @brief Keeps the most recent messages in memory, for embedding the engine
+ * or inspecting a run after the fact.
+ */
+class RingSink : public LogSink {
+   public:
+    /**
+     * @brief A recorded message.
+     */
+    struct Entry {
+        LogLevel level;      /**< The message's level. */
+        std::string message; /**< The message. */
+    };
+
+   private:
+    std::size_t capacity;      /**< Messages kept. */
+    std::deque<Entry> entries; /**< Oldest first. */
+
+   public:
+    /**
+     * @param capacity How many messages to keep; older ones are dropped.
+     */
+    explicit RingSink(std::size_t capacity);
+
+    void write(LogLevel level, std::string_view message) override;
+
+    /**
+     * @brief Gets the kept messages, oldest first. Only call this while no
+     * other thread is logging.
+     * @return The messages.
+     */
+    std::vector<Entry> recent() const;
+};
+
+/**
+ * @brief Levelled logging for the engine.
+ *
+ * Messages below the compile-time floor are removed from the build: only
+ * Info and above are compiled in unless built with `make LOG_DEBUG=1`.
+ * Messages below the runtime level, Warning by default, are dropped when
+ * logged. Either way a filtered message is never formatted; its arguments
+ * are only streamed together once it is known to be written. Messages go
+ * to standard error unless another sink is set. Logging is thread-safe, so
+ * a server's workers can share the sink.
+ */
+class Log {
+    static std::mutex mutex;              /**< Serializes writes to sink. */
+    static std::shared_ptr<LogSink> sink; /**< Where messages go. */
+
+    /**
+     * @brief Writes a formatted message to the sink.
+     */
+    static void emit(LogLevel level, std::string_view message);
+
+   public:
+    static constexpr LogLevel floor =
+#ifdef LOG_DEBUG
+        LogLevel::Debug;
+#else
+        LogLevel::Info;
+#endif
+
+    /**
+     * @brief Checks whether messages at a level are written.
+     * @param level The level.
+     * @return Whether the level passes both filters.
+     */
+    static bool enabled(LogLevel level);
+
+    /**
+     * @brief Sets the runtime level; messages below it are dropped.
+     * @param level The level, or LogLevel::Off to drop everything.
+     */
+    static void setLevel(LogLevel level);
+
+    /**
+     * @brief Sets where messages go.
+     * @param sink The sink; standard error if null.
+     */
+    static void setSink(std::shared_ptr<LogSink> sink);
+
+    /**
+     * @brief Parses a level's name, as given on the command line.
+     * @param name debug, info, warning, error or off.
+     * @return The level.
+     * @throws std::invalid_argument If the name is not a level.
+     */
+    static LogLevel parseLevel(std::string_view name);
+
+    /**
+     * @brief Gets a level's name.
+     * @param level The level.
+     * @return The name, in lower case.
+     */
+    static std::string_view levelName(LogLevel level);
+
+    /**
+     * @brief Logs a message made by streaming the arguments together.
+     * @tparam level The message's level.
+     * @param args What to stream.
+     */
+    template <LogLevel level, typename... Args>
+    static void write(const Args&... args) {
+        if constexpr (level >= floor) {
+            if (!enabled(level)) return;
+            std::ostringstream message;
+            (message << ... << args);
+            emit(level, message.view());
+        }
+    }
+
+    /** @brief Logs at LogLevel::Debug; see write(). */
+    template <typename... Args>
+    static void debug(const Args&... args) {
+        write<LogLevel::Debug>(args...);
+    }
+    /** @brief Logs at LogLevel::Info; see write(). */
+    template <typename... Args>
+    static void info(const Args&... args) {
+        write<LogLevel::Info>(args...);
+    }
+    /** @brief Logs at LogLevel::Warning; see write(). */
+    template <typename... Args>
+    static void warning(const Args&... args) {
+        write<LogLevel::Warning>(args...);
+    }
+    /** @brief Logs at LogLevel::Error; see write(). */
+    template <typename... Args>
+    static void error(const Args&... args) {
+        write<LogLevel::Error>(args...);
+    }
+};
@@ -2,9 +2,11 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
 #include <utility>  // For std::pair
 #include <vector>
 
+#include "arena.h"
 #include "linkmanager.h"
 
 // Forward declarations to avoid circular includes
@@ -20,26 +22,24 @@ class Game;
 class Player {
     std::pair<int, int>
         score; /**< Current score of the player: {data score, virus score}. */
-    std::vector<std::unique_ptr<Ability>>
-        abilities;     /**< Vector of unique_ptr to Ability objects the player
-                          possesses. */
+    std::pmr::vector<ArenaPtr<Ability>>
+        abilities;     /**< The Ability objects the player possesses. */
     int abilitiesUsed; /**< Counter for abilities used by the player in the
                           current turn/game. */
-    std::shared_ptr<LinkManager>
-        linkManager; /**< A shared_ptr to the LinkManager, allowing player to
-                        interact with links. */
+    LinkManager* linkManager; /**< The game's LinkManager, allowing player
+                                 to interact with links. */
 
     Game* game;
 
    public:
     /**
      * @brief Constructor for the Player class.
-     * @param abilities A vector of unique_ptr to Ability objects for this
-     * player.
-     * @param lm A shared_ptr to the LinkManager instance.
+     * @param abilities The Ability objects for this player.
+     * @param lm The game's LinkManager, which must outlive the player.
+     * @param game The game the player is in.
      */
-    Player(std::vector<std::unique_ptr<Ability>> abilities,
-           std::shared_ptr<LinkManager> lm, Game* game);
+    Player(std::pmr::vector<ArenaPtr<Ability>> abilities, LinkManager* lm,
+           Game* game);
 
     /**
      * @brief Gets the player's current score.
@@ -66,9 +66,9 @@ class Player {
 
     /**
      * @brief Gets a constant reference to the player's abilities.
-     * @return A const reference to the vector of unique_ptr to Ability.
+     * @return A const reference to the vector of owned abilities.
      */
-    const std::vector<std::unique_ptr<Ability>> &getAbilities() const;
+    const std::pmr::vector<ArenaPtr<Ability>> &getAbilities() const;
 
     /**
      * @brief Simulates a download action for a given link, typically leading to
@@ -76,4 +76,7 @@ class Player {
      * @param linkKey The LinkManager::LinkKey of the link to be downloaded.
      */
     void download(LinkManager::LinkKey linkKey);
+
+    friend struct GameState; /**< GameState captures and restores scores and
+                                abilities. */
 };
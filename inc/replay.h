@@ -0,0 +1,121 @@
+// replay.h
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "link.h"
+
+class Game;
+struct AbilityArgs;
+
+/**
+ * @brief Everything needed to start a recorded game again.
+ */
+struct ReplayHeader {
+    uint64_t seed = 0; /**< Seed used for random link placements. */
+    unsigned keyframeInterval = 0; /**< Turns between keyframes; 0 for
+                                      none. */
+    std::vector<std::string> abilities; /**< Ability letters per player. */
+    std::vector<std::vector<std::string>>
+        placements; /**< Link placements per player, e.g. "V1". */
+};
+
+/**
+ * @brief Writes a replay file as a game is played.
+ *
+ * The file starts with a ReplayHeader. Each successful action then appends
+ * one packed record:
+ * - a move is one byte: bit 7 clear, link id in bits 0-2, direction in
+ *   bits 3-4;
+ * - an ability is `0x80 | id`, a byte with the argument count in bits 0-5
+ *   and which arguments are numbers in bits 6-7, then two bytes (link id and
+ *   value) per stored argument;
+ * - a turn that ran out of time is `0xE0`;
+ * - a keyframe is `0xF0`, the turn as 4 bytes and a raw GameState.
+ * Multi-byte integers are little-endian.
+ */
+class ReplayWriter {
+    std::ofstream out;  /**< The replay file. */
+    unsigned interval;  /**< Turns between keyframes. */
+
+    /**
+     * @brief Writes a keyframe if the game has reached a multiple of the
+     * interval.
+     * @param game The game after the last recorded action.
+     */
+    void keyframeIfDue(const Game &game);
+
+   public:
+    /**
+     * @brief Creates the file and writes its header.
+     * @param path Where to write the replay.
+     * @param header The game's starting setup.
+     * @throws std::invalid_argument if the file cannot be created.
+     */
+    ReplayWriter(const std::string &path, const ReplayHeader &header);
+
+    /**
+     * @brief Records a move, followed by a keyframe if one is due.
+     * @param game The game after the move.
+     * @param link The id of the moved link.
+     * @param dir The direction it moved.
+     */
+    void recordMove(const Game &game, unsigned link, Link::Direction dir);
+
+    /**
+     * @brief Records a turn that passed without a move, followed by a
+     * keyframe if one is due.
+     * @param game The game after the turn passed.
+     */
+    void recordPass(const Game &game);
+
+    /**
+     * @brief Records an ability use.
+     * @param id The 1-based ability id.
+     * @param args The arguments it was used with.
+     */
+    void recordAbility(int id, const AbilityArgs &args);
+
+    /**
+     * @brief Writes buffered records to disk.
+     */
+    void flush();
+};
+
+/**
+ * @brief Reads a replay file and plays it back.
+ */
+class ReplayReader {
+    std::vector<uint8_t> data; /**< The whole file. */
+    ReplayHeader header;       /**< The parsed header. */
+    size_t recordsStart;       /**< Offset of the first record. */
+
+   public:
+    /**
+     * @brief Reads and checks a replay file.
+     * @param path The file to read.
+     * @throws std::invalid_argument if the file is missing or malformed.
+     */
+    explicit ReplayReader(const std::string &path);
+
+    /**
+     * @brief Gets the recorded starting setup.
+     * @return The header.
+     */
+    const ReplayHeader &getHeader() const;
+
+    /**
+     * @brief Plays a game forward to a turn.
+     *
+     * Restores the last keyframe at or before the turn and replays the
+     * records after it. The game must have been started from the header.
+     * Updates queued while replaying are discarded.
+     * @param game The game to advance.
+     * @param turn The turn to stop at.
+     * @return The turn reached, which is earlier if the replay ends first.
+     */
+    unsigned seek(Game &game, unsigned turn) const;
+};
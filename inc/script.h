@@ -0,0 +1,91 @@
+// script.h
+#pragma once
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A sequence file, memory mapped and split into commands once.
+ *
+ * Commands are views into the mapping: one per non-blank line, or several
+ * when a line separates them with ';'. The mapping lives as long as the
+ * Script, so the views stay valid until it is destroyed.
+ */
+class Script {
+    std::string path; /**< Canonical path of the file. */
+    void *data = nullptr; /**< Start of the mapping, or null for an empty
+                             file. */
+    std::size_t size = 0; /**< Length of the mapping in bytes. */
+    timespec mtime{};     /**< Modification time when the file was read. */
+    std::vector<std::string_view> commands; /**< The file's commands in
+                                               order. */
+
+   public:
+    /**
+     * @brief Maps and splits a sequence file.
+     * @param path Canonical path of the file.
+     * @throws std::invalid_argument if the file cannot be opened or mapped.
+     */
+    explicit Script(std::string path);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~Script();
+
+    Script(const Script &) = delete;
+    Script &operator=(const Script &) = delete;
+
+    /**
+     * @brief Gets the canonical path of the file.
+     * @return The path.
+     */
+    const std::string &getPath() const;
+
+    /**
+     * @brief Gets the commands in the file.
+     * @return The commands, in order, with blank ones removed.
+     */
+    const std::vector<std::string_view> &getCommands() const;
+
+    /**
+     * @brief Checks whether the file has changed since it was read.
+     * @param current The file's current modification time.
+     * @param currentSize The file's current size.
+     * @return True if the cached commands are out of date.
+     */
+    bool isStale(const timespec &current, std::size_t currentSize) const;
+};
+
+/**
+ * @brief Keeps parsed sequence files so scripts run repeatedly, or included
+ * from several others, are only read once.
+ *
+ * Entries are keyed by canonical path and re-read when the file's
+ * modification time or size changes.
+ */
+class ScriptCache {
+    std::unordered_map<std::string, std::unique_ptr<Script>>
+        scripts; /**< Parsed scripts by canonical path. */
+
+   public:
+    /**
+     * @brief Resolves a path as given on the command line.
+     * @param path The path to resolve.
+     * @return The canonical path.
+     * @throws std::invalid_argument if the file does not exist.
+     */
+    static std::string resolve(std::string_view path);
+
+    /**
+     * @brief Gets a script, reading it if it is not cached or has changed.
+     * @param canonical A path returned by resolve.
+     * @return The script, valid until the next get for the same path.
+     * @throws std::invalid_argument if the file cannot be read.
+     */
+    const Script &get(const std::string &canonical);
+};
@@ -0,0 +1,87 @@
+// server.h
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "controller.h"
+
+/**
+ * @brief Hosts many games in one process for clients on a Unix socket.
+ *
+ * Connections are seated in the order they arrive: the first of each pair
+ * plays player 1 and the second player 2, and the pair is a session with its
+ * own Controller and Game, started from the server's GameConfig with its own
+ * seed. Sessions are spread over a fixed pool of worker threads, each running
+ * an EventLoop over its sessions' sockets; no session gets a thread of its
+ * own.
+ *
+ * The protocol is the text command set. The server sends NUL-terminated
+ * messages: once both seats are filled, each is told which player it is
+ * along with the game's start-up prompt. A client sends lines, and the
+ * sender is answered with everything the game printed while running each
+ * one; a line from a player who is not to move is answered with "Not your
+ * turn." instead. Once the turn passes, the other seat is sent the same text
+ * as a message of its own. The server closes both connections once the game
+ * is over or either client leaves. Commands that name files (save, load and
+ * sequence) are refused, since they would run with the server's access to
+ * the file system.
+ *
+ * Each seat has its own TextView, so a board only ever goes to its player's
+ * connection: the player to move is sent its board when the turn reaches it
+ * and in reply to `board`, and the opponent's hidden links stay hidden.
+ */
+class GameServer {
+    struct Seat;
+    struct Session;
+    struct Worker;
+
+    GameConfig config;      /**< Settings every session starts from. */
+    std::string socketPath; /**< Where the listening socket is bound. */
+    int listenFd = -1;      /**< The listening socket. */
+    std::vector<std::unique_ptr<Worker>> workers; /**< The worker pool. */
+    unsigned nextWorker = 0;      /**< Worker the next session goes to. */
+    std::vector<int> waiting; /**< Connections accepted but not yet seated
+                                 in a game. */
+    uint64_t sessionsStarted = 0; /**< Games started so far. */
+    uint64_t baseSeed;            /**< Seed of the first session; each later
+                                     session adds one. */
+
+    /**
+     * @brief Accepts every pending connection and hands each full set of
+     * seats to a worker.
+     */
+    void acceptSessions();
+
+    /**
+     * @brief Prints command throughput and latency percentiles.
+     * @param seconds How long the server ran.
+     */
+    void report(double seconds) const;
+
+   public:
+    /**
+     * @brief Binds the socket. Workers start when run() is called.
+     * @param config Settings every session starts from.
+     * @param socketPath Where to bind; a stale socket there is replaced.
+     * @param workerCount Number of worker threads.
+     * @throws std::runtime_error if the socket cannot be bound.
+     */
+    GameServer(const GameConfig& config, std::string socketPath,
+               unsigned workerCount);
+
+    /**
+     * @brief Closes every session and removes the socket.
+     */
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    /**
+     * @brief Serves clients until SIGINT or SIGTERM, then prints statistics.
+     */
+    void run();
+};
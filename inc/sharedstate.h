@@ -0,0 +1,119 @@
+// sharedstate.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "gamestate.h"
+
+/**
+ * @brief The layout of a POSIX shared memory segment holding a live
+ * GameState.
+ *
+ * One process writes the state and any number read it. The state is guarded
+ * by a seqlock: the writer makes the sequence odd, copies the state in and
+ * makes it even again. A reader copies the state out between two reads of
+ * the sequence and keeps the copy only if both were the same even value.
+ * Readers map the segment read-only and never write to it, so they cannot
+ * hold up the writer.
+ */
+struct SharedState {
+    static constexpr char magic[4] = {'R', 'N', 'S', 'H'}; /**< Marks a
+                                                              segment. */
+    static constexpr uint8_t version = 1; /**< Layout version. */
+
+    char tag[4];        /**< Set to magic once the segment is ready. */
+    uint8_t layout;     /**< Set to version. */
+    uint8_t reserved[3];
+    uint32_t stateSize; /**< sizeof(GameState) in the writer's build. */
+
+    alignas(64) std::atomic<uint32_t> sequence; /**< Odd while the state is
+                                                   being written. */
+    alignas(64) GameState state; /**< The last published state. */
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "SharedState is shared between processes");
+
+/**
+ * @brief Publishes game states to a shared memory segment it creates.
+ */
+class StatePublisher {
+    std::string name;     /**< The segment's name, starting with '/'. */
+    SharedState *shared;  /**< The mapped segment. */
+    GameState staging;    /**< Where a game is captured before it is copied
+                             in, so readers never wait on a capture and a
+                             capture that fails publishes nothing. */
+
+   public:
+    /**
+     * @brief Creates the segment, replacing one of the same name.
+     * @param name The segment's name; a leading '/' is added if missing.
+     * @throws std::runtime_error if the segment cannot be created.
+     */
+    explicit StatePublisher(std::string name);
+
+    /**
+     * @brief Unmaps and removes the segment. Readers that still have it
+     * mapped keep the last state.
+     */
+    ~StatePublisher();
+
+    StatePublisher(const StatePublisher &) = delete;
+    StatePublisher &operator=(const StatePublisher &) = delete;
+
+    /**
+     * @brief Gets the segment's name.
+     * @return The name, starting with '/'.
+     */
+    const std::string &getName() const;
+
+    /**
+     * @brief Replaces the published state with a game's current state.
+     * Never waits for readers and allocates nothing.
+     * @param game The game to publish.
+     * @throws std::length_error if the game does not fit a GameState; the
+     * published state is left as it was.
+     */
+    void publish(const Game &game);
+};
+
+/**
+ * @brief Reads game states from a segment made by a StatePublisher.
+ */
+class StateSubscriber {
+    const SharedState *shared; /**< The segment, mapped read-only. */
+
+   public:
+    /**
+     * @brief Maps an existing segment.
+     * @param name The segment's name; a leading '/' is added if missing.
+     * @throws std::runtime_error if the segment does not exist or was made by
+     * another version or build.
+     */
+    explicit StateSubscriber(std::string name);
+
+    /**
+     * @brief Unmaps the segment.
+     */
+    ~StateSubscriber();
+
+    StateSubscriber(const StateSubscriber &) = delete;
+    StateSubscriber &operator=(const StateSubscriber &) = delete;
+
+    /**
+     * @brief Gets the current sequence number, which changes with every
+     * publish.
+     * @return The sequence number; odd during a publish.
+     */
+    uint32_t getSequence() const;
+
+    /**
+     * @brief Copies out a consistent state, retrying while a publish is in
+     * progress.
+     * @param state Receives the state.
+     * @return The sequence number the state was published under.
+     */
+    uint32_t read(GameState &state) const;
+};
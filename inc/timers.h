@@ -0,0 +1,98 @@
+// timers.h
+#pragma once
+
+#include <chrono>
+#include <ostream>
+
+#include "histogram.h"
+
+/**
+ * @brief Times hot paths into a latency histogram per call site.
+ *
+ * Only built with `make TIMERS=1`. A site is declared as a function-local
+ * static and registers itself the first time it runs; a Scope on the stack
+ * records the time until it is destroyed. Sites are shared by every thread,
+ * so a server's workers add to the same histograms. In a normal build
+ * sites and scopes compile to nothing.
+ */
+class Timers {
+   public:
+    static constexpr bool enabled =
+#ifdef TIMERS
+        true;
+#else
+        false;
+#endif
+
+    /**
+     * @brief A timed call site.
+     */
+    class Site {
+#ifdef TIMERS
+        const char* name;  /**< Shown when printing. */
+        Histogram elapsed; /**< Time spent in the site, in nanoseconds. */
+        Site* next;        /**< The site registered before this one. */
+
+        friend class Timers;
+
+       public:
+        /**
+         * @brief Registers a site.
+         * @param name Name to print; must outlive the program, normally a
+         * string literal.
+         */
+        explicit Site(const char* name);
+
+        /**
+         * @brief Records one pass through the site.
+         * @param nanoseconds How long it took.
+         */
+        void record(uint64_t nanoseconds) { elapsed.record(nanoseconds); }
+#else
+       public:
+        constexpr explicit Site(const char*) {}
+#endif
+        Site(const Site&) = delete;
+        Site& operator=(const Site&) = delete;
+    };
+
+    /**
+     * @brief Times a site from construction to destruction.
+     */
+    class Scope {
+#ifdef TIMERS
+        Site& site; /**< Where the time is recorded. */
+        std::chrono::steady_clock::time_point
+            started; /**< When the scope was entered. */
+
+       public:
+        /**
+         * @brief Starts timing.
+         * @param site Where the time is recorded.
+         */
+        explicit Scope(Site& site)
+            : site{site}, started{std::chrono::steady_clock::now()} {}
+
+        /**
+         * @brief Records the time since construction.
+         */
+        ~Scope() {
+            auto took = std::chrono::steady_clock::now() - started;
+            site.record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(took)
+                    .count());
+        }
+#else
+       public:
+        explicit Scope(Site&) {}
+#endif
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * @brief Prints the count, p50, p99 and max of every site that has run.
+     * @param out Where to print.
+     */
+    static void print(std::ostream& out);
+};
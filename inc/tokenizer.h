@@ -0,0 +1,49 @@
+// tokenizer.h
+#pragma once
+
+#include <string_view>
+
+/**
+ * @brief Splits a command line into whitespace separated tokens without
+ * copying.
+ *
+ * Tokens are views into the original line, which must outlive the tokenizer
+ * and every token taken from it.
+ */
+class Tokenizer {
+    std::string_view rest; /**< The part of the line not yet consumed. */
+
+   public:
+    /**
+     * @brief Constructor for Tokenizer.
+     * @param line The line to split.
+     */
+    explicit Tokenizer(std::string_view line);
+
+    /**
+     * @brief Takes the next token.
+     * @return The token, or an empty view once the line is exhausted.
+     */
+    std::string_view next();
+
+    /**
+     * @brief Takes the next token and parses it as a decimal integer.
+     * @param value Set to the parsed value on success.
+     * @return True if there was a token and all of it was a number.
+     */
+    bool nextInt(int &value);
+
+    /**
+     * @brief Checks whether any tokens remain.
+     * @return True if only whitespace is left.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Parses a whole token as a decimal integer.
+     * @param token The token to parse.
+     * @param value Set to the parsed value on success.
+     * @return True if the token was non-empty and entirely a number.
+     */
+    static bool toInt(std::string_view token, int &value);
+};
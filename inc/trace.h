@@ -0,0 +1,63 @@
+// trace.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Records timed spans as Chrome trace events, for chrome://tracing or
+ * Perfetto.
+ *
+ * Each thread writes its spans to its own ring buffer without locking; once
+ * a buffer is full the oldest spans are overwritten. Nothing is written to
+ * disk until stop(), which must run after every traced thread has finished.
+ * While tracing is off a Span costs one relaxed load.
+ */
+class Trace {
+   public:
+    /**
+     * @brief Times a span of work on the current thread.
+     */
+    class Span {
+        std::string_view name; /**< What is being done. */
+        const char* category;  /**< Group for filtering in the viewer. */
+        int64_t started;       /**< Start time; negative if not tracing. */
+
+       public:
+        /**
+         * @brief Starts a span if tracing is on.
+         * @param name What is being done; must outlive the trace, normally a
+         * string literal.
+         * @param category Group for filtering; likewise a literal.
+         */
+        Span(std::string_view name, const char* category);
+
+        /**
+         * @brief Ends the span and records it.
+         */
+        ~Span();
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+    };
+
+    /**
+     * @brief Starts tracing.
+     * @param path Where stop() writes the trace.
+     */
+    static void start(std::string path);
+
+    /**
+     * @brief Stops tracing and writes every buffered span. Does nothing if
+     * tracing was never started.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    static void stop();
+
+    /**
+     * @brief Names the current thread in the trace.
+     * @param name The name.
+     */
+    static void nameThread(std::string name);
+};
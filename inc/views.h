@@ -1,13 +1,19 @@
 // views.h
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <string>
+#include <thread>
 #include <utility>  // For std::pair
 #include <vector>
 
 #include "linkmanager.h"
-#include "window.h"
+#include "backend.h"
 
 class Game;
 class Player;
@@ -155,6 +161,7 @@ class View {
 class TextView : public View {
     std::vector<std::vector<std::string>>
         board; /**< 2D vector of strings representing the textual game board. */
+    std::ostream &out; /**< Where the view is printed. */
 
     /**
      * @brief Sets the string representation of a specific coordinate on the
@@ -175,8 +182,9 @@ class TextView : public View {
      * @param game A const pointer to the Game model.
      * @param viewer A const pointer to the Player whose perspective this view
      * will display.
+     * @param out Where to print the view.
      */
-    TextView(const Game *game, const Player *viewer);
+    TextView(const Game *game, const Player *viewer, std::ostream &out);
 
     /**
      * @brief Updates the TextView based on a cell change.
@@ -209,82 +217,236 @@ class TextView : public View {
     void display() const override;
 };
 
+/**
+ * @brief A view for an external bot, kept as a stream of text deltas.
+ *
+ * The bot sees what a TextView for the same player would show. The view
+ * starts with a full snapshot and then appends one line per change:
+ * - `c <row> <col> <cell>`: a cell now shows this character;
+ * - `r <link> <value>`: a link's identity became known, e.g. `r A V3`;
+ * - `a <player> <count>`: a player's remaining abilities;
+ * - `s <player> <data> <viruses>`: a player's score.
+ * The snapshot is one `b <row> <cells>` line per board row followed by the
+ * r, a and s lines for everything already known. Players are numbered from 1.
+ */
+class BotView : public View {
+    std::string deltas; /**< Lines not yet taken by the arbiter. */
+
+   public:
+    /**
+     * @brief Constructor for BotView. Queues the snapshot.
+     * @param game A const pointer to the Game model.
+     * @param viewer A const pointer to the Player the bot plays.
+     */
+    BotView(const Game *game, const Player *viewer);
+
+    /**
+     * @brief Queues a cell delta.
+     * @param update A CellUpdate struct.
+     */
+    void update(CellUpdate update) override;
+
+    /**
+     * @brief Queues a reveal delta if the bot may see it.
+     * @param update A RevealLinkUpdate struct.
+     */
+    void update(RevealLinkUpdate update) override;
+
+    /**
+     * @brief Queues an ability count delta.
+     * @param update An AbilityCountUpdate struct.
+     */
+    void update(AbilityCountUpdate update) override;
+
+    /**
+     * @brief Queues a score delta.
+     * @param update A ScoreUpdate struct.
+     */
+    void update(ScoreUpdate update) override;
+
+    /**
+     * @brief Takes the lines queued since the last call.
+     * @return The deltas, each ending in a newline; empty if nothing changed.
+     */
+    std::string takeDeltas();
+
+    /**
+     * @brief No-op; bots are sent deltas instead.
+     */
+    void display() const override;
+};
+
 /**
  * @brief Concrete implementation of View for graphical display
  *
- * This class is intended to provide a graphical representation of the game,
- * but its methods are currently placeholders.
+ * Draws the board and player panels through a RenderBackend. Updates are
+ * applied to a pending copy of the view state on the caller's thread. With an
+ * interactive backend a dedicated render thread snapshots that state, redraws
+ * what changed at most once per frame interval, and repaints on Expose
+ * events; offscreen backends render every frame synchronously instead.
  */
-class GraphicsView : public View, public Xwindow {
+class GraphicsView : public View {
+    std::unique_ptr<RenderBackend> backend; /**< Where frames are drawn. */
     unsigned height;
     unsigned width;
 
     LinkManager *lm;
     Board *b;
     Game *game;
-    std::vector<std::vector<char>> boardStates;
 
+    /**
+     * @brief What the view knows about one link. Slots are indexed by link
+     * id and keep their type and strength after the link is downloaded.
+     */
     struct linkDat {
-        int strength;
-        char type;
-        std::string suffix;
-        int r;
-        int c;
+        bool onBoard = false;
+        int strength = 0;
+        char type = '?';
+        int r = 0;
+        int c = 0;
     };
 
     struct PlayerInfo {
         bool isAlive;
-        unsigned int revealedLinks;  // bitmask for revealed links
-        std::vector<linkDat> linkRepresentations;
+        unsigned int revealedLinks;  // links this player knows (knowledge matrix row)
+        std::array<linkDat, 8> links;
         unsigned int abilitiesLeft;
         std::pair<int, int> score;
         int colour;
-        Player *player;
     };
 
-    int cPlayer;
+    struct Rect {
+        int x;
+        int y;
+        int w;
+        int h;
+    };
+
+    /**
+     * @brief Everything needed to draw a frame, including what changed since
+     * the last one.
+     */
+    struct ViewState {
+        int cPlayer;
+        std::vector<std::vector<char>> boardStates;
+        std::vector<std::vector<int>> occupants; /**< playerIndex * 8 + link
+                                                    id on each cell, or -1. */
+        std::vector<PlayerInfo> players;
+        bool fullRedraw;
+        std::vector<std::vector<bool>> dirtyCells;
+        std::vector<bool> dirtyPanels;
+    };
 
     int nPlayers;
-    std::vector<PlayerInfo> players;
+
+    // board geometry, fixed for the lifetime of the window
+    int cellSize;
+    int gridX;
+    int gridY;
+
+    ViewState pending; /**< Written by updates, guarded by stateMutex. */
+    ViewState front;   /**< Snapshot being drawn; render thread only. */
+    std::vector<Rect> damage;
+
+    // render thread
+    static constexpr std::chrono::milliseconds frameInterval{16};
+    std::mutex stateMutex;
+    bool frameRequested = false;
+    bool stopping = false;
+    int wakeFd; /**< eventfd used to wake the render thread. */
+    std::thread renderThread;
 
     void drawBoard();
+    void drawCell(int r, int c, int layer);
     void drawPlayerInfo(int playerIndex, int x, int y);
-    void updateCurrentPlayerRevealedLinks();
     void displayImpl();
 
+    Rect cellRect(int r, int c) const;
+    Rect panelRect(int playerIndex) const;
+    void markCell(int r, int c);
+    void markPlayerLinks(int playerIndex);
+    linkDat &slot(int occupant);
+
+    /**
+     * @brief Reads the whole pending state from the model. The caller holds
+     * stateMutex or has not started the render thread yet.
+     */
+    void readGame();
+
+    /**
+     * @brief Asks for a frame. The render thread coalesces bursts of requests
+     * within one frame interval; without one the frame is drawn immediately.
+     */
+    void requestFrame();
+
+    /**
+     * @brief Copies the pending state into the snapshot being drawn and
+     * resets the pending damage.
+     */
+    void takeSnapshot();
+
+    /**
+     * @brief Body of the render thread.
+     */
+    void renderLoop();
+
    public:
     /**
-     * @brief Constructor for GraphicsView.
-     * @param game A const pointer to the Game model.
-     * will display.
+     * @brief Constructor for GraphicsView. Starts the render thread if the
+     * backend is interactive.
+     * @param game A pointer to the Game model.
+     * @param backend The surface to draw on.
+     */
+    GraphicsView(Game *game, std::unique_ptr<RenderBackend> backend);
+
+    /**
+     * @brief Stops the render thread before the window is destroyed.
+     */
+    ~GraphicsView();
+
+    /**
+     * @brief Follows the game's current player and schedules a frame. Called
+     * after each batch of updates.
      */
-    GraphicsView(Game *game);
     void refresh();
+
+    /**
+     * @brief Discards the view's state and reads it again from the model,
+     * then redraws everything. Used after the game is replaced wholesale.
+     */
+    void reload();
+
+    /**
+     * @brief Updates a board cell in the graphical view.
+     * @param update A CellUpdate struct.
+     */
     void update(CellUpdate update) override;
 
     /**
-     * @brief Placeholder update for revealing links in the graphical view.
+     * @brief Updates link visibility in the graphical view.
      * @param update A RevealLinkUpdate struct.
      */
     void update(RevealLinkUpdate update) override;
 
     /**
-     * @brief Placeholder update for ability count changes in the graphical
-     * view.
+     * @brief Updates a player's ability count in the graphical view.
      * @param update An AbilityCountUpdate struct.
      */
     void update(AbilityCountUpdate update) override;
 
     /**
-     * @brief Placeholder update for score changes in the graphical view.
+     * @brief Updates a player's score in the graphical view.
      * @param update A ScoreUpdate struct.
      */
     void update(ScoreUpdate update) override;
+
+    /**
+     * @brief Schedules a frame.
+     */
     void realdisplay();
 
     /**
-     * @brief Placeholder for displaying the graphical game.
+     * @brief No-op; the render thread keeps the window up to date.
      */
     void display() const override;
-    void nextTurn();
 };
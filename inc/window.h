@@ -2,9 +2,14 @@
 #define WINDOW_H
 #include <X11/Xlib.h>
 
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
-class Xwindow {
+#include "backend.h"
+
+class Xwindow : public RenderBackend {
     Display* d;
     Window w;
     int s, width, height;
@@ -13,38 +18,64 @@ class Xwindow {
     Pixmap pix;
     XColor makeColour(Display* d, Colormap cmap, unsigned int hex);
 
+    // GC state last sent to the server, so redundant changes are skipped
+    int gcColour;
+    int gcThickness;
+    void setColour(int colour);
+    void setThickness(int thickness);
+
+    // Queued primitives, grouped by colour and by (thickness, colour)
+    std::vector<XRectangle> rectBatch[10];
+    std::map<std::pair<int, int>, std::vector<XSegment>> segmentBatch;
+
    public:
-    Xwindow(int width = 500,
-            int height = 500);  // Constructor; displays the window.
-    ~Xwindow();                 // Destructor; destroys the window.
-
-    enum {
-        White = 0,
-        Black,
-        lRed,
-        dRed,
-        lGreen,
-        dGreen,
-        lBlue,
-        dBlue,
-        lPurple,
-        dPurple
-    };  // Available colours.
-
-    int getWidth() const;
-    int getHeight() const;
+    // Constructor; displays the window. Throws std::runtime_error if there
+    // is no display to connect to.
+    Xwindow(int width = 500, int height = 500);
+    ~Xwindow();  // Destructor; destroys the window.
+
+    int getWidth() const override;
+    int getHeight() const override;
 
     // Draws a rectangle TO BUFFER
-    void fillRectangle(int x, int y, int width, int height, int colour = Black);
+    void fillRectangle(int x, int y, int width, int height, int colour = Black) override;
 
     // Draws a string TO BUFFER
-    void drawString(int x, int y, std::string msg);
+    void drawString(int x, int y, const std::string& msg) override;
 
     // Draws a line TO BUFFER
-    void drawLine(int x1, int y1, int x2, int y2, int thickness = 1, int colour = Black);
+    void drawLine(int x1, int y1, int x2, int y2, int thickness = 1, int colour = Black) override;
+
+    // Queues a rectangle for the next flushBatch
+    void queueRectangle(int x, int y, int width, int height, int colour = Black) override;
+
+    // Queues a line for the next flushBatch
+    void queueLine(int x1, int y1, int x2, int y2, int thickness = 1, int colour = Black) override;
+
+    // Draws all queued primitives TO BUFFER with one request per colour and
+    // line width. Rectangles are drawn before lines; queued rectangles of
+    // different colours must not overlap, so flush between layers.
+    void flushBatch() override;
 
-    void display();
+    void display() override;
+
+    // Copies a region of the buffer to the window without flushing
+    void displayArea(int x, int y, int width, int height) override;
+
+    // Sends any pending requests to the X server
+    void flush() override;
+
+    // Waits until the X server has processed every request
+    void sync();
 
     void clear();
+
+    bool isInteractive() const override;
+
+    // File descriptor of the X connection, for polling
+    int getConnectionFd() const override;
+
+    // Drains pending X events; returns true if the window needs repainting
+    bool handleEvents() override;
 };
 #endif
@@ -5,18 +5,22 @@
 #include <stdexcept>
 #include <string>
 
+#include "allocstats.h"
 #include "board.h"
 #include "cell.h"
 #include "game.h"
 #include "link.h"
 #include "linkmanager.h"
 #include "player.h"
+#include "timers.h"
 
-Ability::Ability(std::string name) : name(name), used(false) {}
+Ability::Ability(std::string_view name) : name(name), used(false) {}
 
 bool Ability::isUsed() const { return used; }
 
-std::string Ability::getName() const { return name; }
+void Ability::markUsed() { used = true; }
+
+std::string_view Ability::getName() const { return name; }
 
 LinkManager::LinkKey Ability::getLinkKeyFromId(const Game& game,
                                                const char& linkId) {
@@ -37,29 +41,31 @@ LinkManager::LinkKey Ability::getLinkKeyFromId(const Game& game,
 
 FirewallAbility::FirewallAbility() : Ability("Firewall") {}
 
-void FirewallAbility::use(Game& game, const std::vector<std::string>& params) {
+void FirewallAbility::use(Game& game, const AbilityArgs& args) {
+    static Timers::Site site{"FirewallAbility::use"};
+    Timers::Scope timer{site};
     std::pair<int, int> coords;
-    if (params.size() != 2) {
+    if (args.count != 2) {
         throw std::invalid_argument("Invalid number of parameters");
     }
 
-    std::unique_ptr<BaseCell> baseCell;
-    try {
-        coords.second = std::stoi(params[0]);
-        coords.first = std::stoi(params[1]) - 1;
-        baseCell =
-            std::move(game.getBoard().getBoard()[coords.first][coords.second]);
-    } catch (const std::invalid_argument& e) {
+    auto& board = game.getBoard().getBoard();
+    if (!args.numeric[0] || !args.numeric[1]) {
+        throw std::invalid_argument("Invalid coordinates");
+    }
+    coords.second = args.values[0];
+    coords.first = args.values[1] - 1;
+    if (coords.first < 0 || coords.first >= (int)board.size() ||
+        coords.second < 0 || coords.second >= (int)board[0].size()) {
         throw std::invalid_argument("Invalid coordinates");
     }
 
-    if (baseCell->isOccupied() || !baseCell->canDecorate()) {
+    // validate before the board wraps the cell
+    const BaseCell& target = *board[coords.first][coords.second];
+    if (target.isOccupied() || !target.canDecorate()) {
         throw std::invalid_argument("Cell is occupied or is a server");
     }
-
-    game.getBoard().getBoard()[coords.first][coords.second] =
-        std::make_unique<Firewall>(std::move(baseCell),
-                                   game.getCurrentPlayer());
+    game.getBoard().addFirewall(coords, game.getCurrentPlayer());
 
     View::CellUpdate cellUpdate{coords.first, coords.second};
 
@@ -81,11 +87,13 @@ void FirewallAbility::use(Game& game, const std::vector<std::string>& params) {
 
 DownloadAbility::DownloadAbility() : Ability("Download") {}
 
-void DownloadAbility::use(Game& game, const std::vector<std::string>& params) {
-    if (params.size() != 1) {
+void DownloadAbility::use(Game& game, const AbilityArgs& args) {
+    static Timers::Site site{"DownloadAbility::use"};
+    Timers::Scope timer{site};
+    if (args.count != 1) {
         throw std::invalid_argument("Invalid number of parameters");
     }
-    char linkId = params[0][0];
+    char linkId = args.linkIds[0];
     auto key = Ability::getLinkKeyFromId(game, linkId);
     if (key.player == game.getCurrentPlayer()) {
         throw std::invalid_argument("You can't download a link you own");
@@ -98,10 +106,7 @@ void DownloadAbility::use(Game& game, const std::vector<std::string>& params) {
 
     unsigned playerId = game.getPlayerIndex(*game.getCurrentPlayer());
 
-    std::string value = (link.getType() == Link::LinkType::DATA ? "D" : "V") +
-                        std::to_string(link.getStrength());
-    View::RevealLinkUpdate revealUpdate{playerId, key.id, value};
-
+    // downloading reveals the link to the current player
     game.getCurrentPlayer()->download(key);
 
     View::ScoreUpdate scoreUpdate{playerId,
@@ -124,21 +129,28 @@ void DownloadAbility::use(Game& game, const std::vector<std::string>& params) {
 
 LinkBoostAbility::LinkBoostAbility() : Ability("LinkBoost") {}
 
-void LinkBoostAbility::use(Game& game, const std::vector<std::string>& params) {
-    if (params.size() != 1) {
+void LinkBoostAbility::use(Game& game, const AbilityArgs& args) {
+    static Timers::Site site{"LinkBoostAbility::use"};
+    Timers::Scope timer{site};
+    if (args.count != 1) {
         throw std::invalid_argument("Invalid number of parameters");
     }
-    char linkId = params[0][0];
+    char linkId = args.linkIds[0];
     auto key = Ability::getLinkKeyFromId(game, linkId);
     if (key.player != game.getCurrentPlayer()) {
         throw std::invalid_argument("You can only boost links you own");
     }
 
-    std::function<std::unique_ptr<Link>(std::unique_ptr<Link>)> lambda =
-        [](std::unique_ptr<Link> p) {
-            return std::make_unique<LinkBoostDecorator>(std::move(p));
-        };
-    game.getLinkManager().applyDecorator(key, lambda);
+    {
+        // building the std::function is part of the decorator's cost
+        AllocStats::Scope scope{AllocTag::Decorators};
+        std::function<ArenaPtr<Link>(ArenaPtr<Link>)> lambda =
+            [&](ArenaPtr<Link> p) {
+                return makeArena<LinkBoostDecorator>(game.getArena(),
+                                                     std::move(p));
+            };
+        game.getLinkManager().applyDecorator(key, lambda);
+    }
 
     unsigned playerId = game.getPlayerIndex(*game.getCurrentPlayer());
 
@@ -157,21 +169,27 @@ void LinkBoostAbility::use(Game& game, const std::vector<std::string>& params) {
 
 PolarizeAbility::PolarizeAbility() : Ability("Polarize") {}
 
-void PolarizeAbility::use(Game& game, const std::vector<std::string>& params) {
-    if (params.size() != 1) {
+void PolarizeAbility::use(Game& game, const AbilityArgs& args) {
+    static Timers::Site site{"PolarizeAbility::use"};
+    Timers::Scope timer{site};
+    if (args.count != 1) {
         throw std::invalid_argument("Invalid number of parameters");
     }
-    char linkId = params[0][0];
+    char linkId = args.linkIds[0];
     auto key = Ability::getLinkKeyFromId(game, linkId);
     if (key.player != game.getCurrentPlayer()) {
         throw std::invalid_argument("You can only polarize links you own");
     }
 
-    std::function<std::unique_ptr<Link>(std::unique_ptr<Link>)> lambda =
-        [](std::unique_ptr<Link> p) {
-            return std::make_unique<PolarizeDecorator>(std::move(p));
-        };
-    game.getLinkManager().applyDecorator(key, lambda);
+    {
+        AllocStats::Scope scope{AllocTag::Decorators};
+        std::function<ArenaPtr<Link>(ArenaPtr<Link>)> lambda =
+            [&](ArenaPtr<Link> p) {
+                return makeArena<PolarizeDecorator>(game.getArena(),
+                                                    std::move(p));
+            };
+        game.getLinkManager().applyDecorator(key, lambda);
+    }
 
     const auto& link = game.getLinkManager().getLink(key);
     const auto& coords = link.getCoords();
@@ -180,9 +198,9 @@ void PolarizeAbility::use(Game& game, const std::vector<std::string>& params) {
 
     View::CellUpdate cellUpdate{coords.first, coords.second};
 
-    std::string value = (link.getType() == Link::LinkType::DATA ? "D" : "V") +
-                        std::to_string(link.getStrength());
-    View::RevealLinkUpdate revealUpdate{playerId, key.id, value};
+    // the owner always knows their link, so push the new value directly;
+    // views decide who may see it from the knowledge matrix
+    View::RevealLinkUpdate revealUpdate = game.getRevealUpdate(key);
 
     game.getCurrentPlayer()->incrementAbilityUse();
 
@@ -200,39 +218,31 @@ void PolarizeAbility::use(Game& game, const std::vector<std::string>& params) {
 
 ScanAbility::ScanAbility() : Ability("Scan") {}
 
-void ScanAbility::use(Game& game, const std::vector<std::string>& params) {
-    if (params.size() != 1) {
+void ScanAbility::use(Game& game, const AbilityArgs& args) {
+    static Timers::Site site{"ScanAbility::use"};
+    Timers::Scope timer{site};
+    if (args.count != 1) {
         throw std::invalid_argument("Invalid number of parameters");
     }
-    char linkId = params[0][0];
+    char linkId = args.linkIds[0];
     auto key = Ability::getLinkKeyFromId(game, linkId);
     if (key.player == game.getCurrentPlayer()) {
         throw std::invalid_argument("Bro, why are you scanning your own links");
     }
 
-    std::function<std::unique_ptr<Link>(std::unique_ptr<Link>)> lambda =
-        [](std::unique_ptr<Link> p) {
-            return std::make_unique<RevealDecorator>(std::move(p));
-        };
-    game.getLinkManager().applyDecorator(key, lambda);
-
-    const auto& link = game.getLinkManager().getLink(key);
+    if (!game.getLinkManager().hasLink(key)) {
+        throw std::invalid_argument("Link does not exist");
+    }
 
     unsigned playerId = game.getPlayerIndex(*game.getCurrentPlayer());
 
-    std::string value = (link.getType() == Link::LinkType::DATA ? "D" : "V") +
-                        std::to_string(link.getStrength());
-    unsigned oppId = game.getPlayerIndex(*key.player);
-
-    View::RevealLinkUpdate revealUpdate{oppId, key.id, value};
-
     game.getCurrentPlayer()->incrementAbilityUse();
 
     unsigned abilityCount = game.getCurrentPlayer()->getAbilities().size() -
                             game.getCurrentPlayer()->getAbilitiesUsed();
     View::AbilityCountUpdate abilityCountUpdate{playerId, abilityCount};
 
-    game.addUpdate(revealUpdate);
+    game.revealLink(key, *game.getCurrentPlayer());
     game.addUpdate(abilityCountUpdate);
     used = true;
 }
@@ -240,12 +250,14 @@ void ScanAbility::use(Game& game, const std::vector<std::string>& params) {
 // WormHole
 WormHoleAbility::WormHoleAbility() : Ability("WormHole") {}
 
-void WormHoleAbility::use(Game& game, const std::vector<std::string>& params) {
-    if (params.size() != 2) {
+void WormHoleAbility::use(Game& game, const AbilityArgs& args) {
+    static Timers::Site site{"WormHoleAbility::use"};
+    Timers::Scope timer{site};
+    if (args.count != 2) {
         throw std::invalid_argument("Invalid number of parameters");
     }
-    char linkId = params[0][0];
-    char partnerId = params[1][0];
+    char linkId = args.linkIds[0];
+    char partnerId = args.linkIds[1];
     auto linkKey = Ability::getLinkKeyFromId(game, linkId);
     auto partnerKey = Ability::getLinkKeyFromId(game, partnerId);
     if (partnerKey.player != linkKey.player &&
@@ -288,12 +300,14 @@ QuantumEntanglementAbility::QuantumEntanglementAbility()
     : Ability("QuantumEntanglement") {}
 
 void QuantumEntanglementAbility::use(Game& game,
-                                     const std::vector<std::string>& params) {
-    if (params.size() != 2) {
+                                     const AbilityArgs& args) {
+    static Timers::Site site{"QuantumEntanglementAbility::use"};
+    Timers::Scope timer{site};
+    if (args.count != 2) {
         throw std::invalid_argument("Invalid number of parameters");
     }
-    char linkId = params[0][0];
-    char partnerId = params[1][0];
+    char linkId = args.linkIds[0];
+    char partnerId = args.linkIds[1];
     auto link = Ability::getLinkKeyFromId(game, linkId);
     auto partner = Ability::getLinkKeyFromId(game, partnerId);
     if (partner.player != link.player &&
@@ -301,12 +315,16 @@ void QuantumEntanglementAbility::use(Game& game,
         throw std::invalid_argument("You must own both links to entangle them");
     }
 
-    std::function<std::unique_ptr<Link>(std::unique_ptr<Link>)> lambda =
-        [&](std::unique_ptr<Link> p) {
-            return std::make_unique<QuantumEntanglementDecorator>(
-                std::move(p), &game.getLinkManager().getLink(partner));
-        };
-    game.getLinkManager().applyDecorator(link, lambda);
+    {
+        AllocStats::Scope scope{AllocTag::Decorators};
+        std::function<ArenaPtr<Link>(ArenaPtr<Link>)> lambda =
+            [&](ArenaPtr<Link> p) {
+                return makeArena<QuantumEntanglementDecorator>(
+                    game.getArena(), std::move(p),
+                    &game.getLinkManager().getLink(partner));
+            };
+        game.getLinkManager().applyDecorator(link, lambda);
+    }
 
     unsigned playerId = game.getPlayerIndex(*game.getCurrentPlayer());
 
@@ -324,7 +342,9 @@ void QuantumEntanglementAbility::use(Game& game,
 
 PappleAbility::PappleAbility() : Ability("Papple") {}
 
-void PappleAbility::use(Game& game, const std::vector<std::string>& params) {
+void PappleAbility::use(Game& game, const AbilityArgs& args) {
+    static Timers::Site site{"PappleAbility::use"};
+    Timers::Scope timer{site};
     // TODO: DESHITTIFY
     const auto& board = game.getBoard().getBoard();
     Player* currentPlayer = game.getCurrentPlayer();
@@ -0,0 +1,102 @@
+#include "allocstats.h"
+
+#ifdef ALLOC_STATS
+#include <malloc.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+namespace {
+
+constexpr std::size_t tags = static_cast<std::size_t>(AllocTag::Count);
+
+constexpr const char *tagNames[tags] = {
+    "other", "game", "board", "links", "decorators", "views", "parsing",
+    "updates", "publish"};
+
+// plain counters only: anything that allocates here would recurse
+std::atomic<uint64_t> allocations[tags];
+std::atomic<uint64_t> bytes[tags];
+std::atomic<int64_t> liveBlocks;
+std::atomic<int64_t> liveBytes;
+std::atomic<uint64_t> turns;
+
+thread_local AllocTag current = AllocTag::Other;
+
+void *allocate(std::size_t size) {
+    void *memory = std::malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc{};
+    // the usable size is what free gives back, so live bytes balance
+    std::size_t usable = malloc_usable_size(memory);
+    auto tag = static_cast<std::size_t>(current);
+    allocations[tag].fetch_add(1, std::memory_order_relaxed);
+    bytes[tag].fetch_add(size, std::memory_order_relaxed);
+    liveBlocks.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_add(usable, std::memory_order_relaxed);
+    return memory;
+}
+
+void release(void *memory) {
+    if (!memory) return;
+    liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+    liveBytes.fetch_sub(malloc_usable_size(memory),
+                        std::memory_order_relaxed);
+    std::free(memory);
+}
+
+}  // namespace
+
+// the array, nothrow and sized forms all forward to these
+void *operator new(std::size_t size) { return allocate(size); }
+void operator delete(void *memory) noexcept { release(memory); }
+void operator delete(void *memory, std::size_t) noexcept { release(memory); }
+
+AllocStats::Scope::Scope(AllocTag tag) : previous{current} { current = tag; }
+
+AllocStats::Scope::~Scope() { current = previous; }
+
+void AllocStats::endTurn() { turns.fetch_add(1, std::memory_order_relaxed); }
+
+void AllocStats::print(std::ostream &out) {
+    uint64_t turnCount = turns.load(std::memory_order_relaxed);
+    uint64_t totalAllocations = 0;
+    uint64_t totalBytes = 0;
+    out << "Allocations over " << turnCount << " turns:\n"
+        << std::left << std::setw(12) << "subsystem" << std::right
+        << std::setw(12) << "allocs" << std::setw(14) << "bytes"
+        << std::setw(14) << "allocs/turn" << std::setw(14) << "bytes/turn"
+        << "\n";
+    auto perTurn = [&](uint64_t total) {
+        return turnCount ? double(total) / turnCount : 0.0;
+    };
+    auto row = [&](const char *name, uint64_t count, uint64_t size) {
+        out << std::left << std::setw(12) << name << std::right
+            << std::setw(12) << count << std::setw(14) << size
+            << std::setw(14) << perTurn(count) << std::setw(14)
+            << perTurn(size) << "\n";
+    };
+    for (std::size_t i = 0; i < tags; ++i) {
+        uint64_t count = allocations[i].load(std::memory_order_relaxed);
+        uint64_t size = bytes[i].load(std::memory_order_relaxed);
+        totalAllocations += count;
+        totalBytes += size;
+        row(tagNames[i], count, size);
+    }
+    row("total", totalAllocations, totalBytes);
+    out << "Live heap: " << liveBytes.load(std::memory_order_relaxed)
+        << " bytes in " << liveBlocks.load(std::memory_order_relaxed)
+        << " blocks\n";
+}
+
+#else
+
+void AllocStats::endTurn() {}
+
+void AllocStats::print(std::ostream &out) {
+    out << "Allocation stats are off; rebuild with `make clean` and "
+           "`make ALLOC_STATS=1`.\n";
+}
+
+#endif
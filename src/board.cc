@@ -8,26 +8,48 @@
 #include <iostream>
 #include <vector>
 
+#include "allocstats.h"
 #include "cell.h"
 #include "game.h"
 #include "link.h"
 #include "linkmanager.h"
+#include "log.h"
 #include "player.h"
-
-Board::Board(unsigned rows, unsigned cols)
-    : board(rows), rows{rows}, cols{cols} {
+#include "timers.h"
+#include "trace.h"
+
+Board::Board(unsigned rows, unsigned cols, std::pmr::memory_resource* arena)
+    : arena{arena},
+      board(rows, arena),
+      rows{rows},
+      cols{cols},
+      squares{arena} {
     for (unsigned r = 0; r < rows; ++r) {
+        board[r].reserve(cols);
         for (unsigned c = 0; c < cols; ++c) {
-            board[r].push_back(std::make_unique<BoardCell>());
+            board[r].push_back(makeArena<BoardCell>(arena));
         }
     }
 }
 
-void Board::placePlayerCells(const std::vector<std::pair<int, int>> placements,
+Board::PlayerSquares& Board::squaresOf(Player* player) {
+    for (auto& entry : squares) {
+        if (entry.owner == player) return entry;
+    }
+    squares.push_back({player, std::pmr::vector<std::pair<int, int>>{arena},
+                       std::pmr::vector<std::pair<int, int>>{arena}});
+    return squares.back();
+}
+
+void Board::placePlayerCells(const std::vector<std::pair<int, int>>& placements,
                              Player* player, unsigned goalRow, Game* game) {
+    AllocStats::Scope scope{AllocTag::Board};
+    auto& owned = squaresOf(player).owned;
     for (int i = 0; i < 2; ++i) {
         auto& [r, c] = placements[i];
-        board[r][c] = std::make_unique<Server>(std::move(board[r][c]), player);
+        board[r][c] =
+            makeArena<Server>(arena, std::move(board[r][c]), player);
+        owned.push_back(placements[i]);
     }
 
     for (unsigned i = 2; i < placements.size(); ++i) {
@@ -39,27 +61,71 @@ void Board::placePlayerCells(const std::vector<std::pair<int, int>> placements,
 
     for (unsigned c = 0; c < cols; ++c) {
         board[goalRow][c] =
-            std::make_unique<Goal>(std::move(board[goalRow][c]), player);
+            makeArena<Goal>(arena, std::move(board[goalRow][c]), player);
+        owned.push_back({goalRow, c});
     }
 }
 
-void Board::removePlayerCells(Player *player) {
-    for (unsigned r=0; r<rows; ++r) {
-        for (unsigned c=0; c<cols; ++c) {
-            undecorateCell(board[r][c], player);
-            if (board[r][c]->isOccupied()) {
-                std::cout << r << " " << c << "\n";
-                auto lk = board[r][c]->getOccupantLink();
-                if (lk.player == player) {
-                    board[r][c]->emptyCell();
+void Board::addFirewall(std::pair<int, int> coords, Player *owner) {
+    AllocStats::Scope scope{AllocTag::Board};
+    auto &[r, c] = coords;
+    board[r][c] = makeArena<Firewall>(arena, std::move(board[r][c]), owner);
+    squaresOf(owner).owned.push_back(coords);
+}
+
+void Board::linkRemoved(Player *owner, std::pair<int, int> coords) {
+    squaresOf(owner).vacated.push_back(coords);
+}
+
+void Board::reindex() {
+    squares.clear();
+    for (unsigned r = 0; r < rows; ++r) {
+        for (unsigned c = 0; c < cols; ++c) {
+            const BaseCell *cell = board[r][c].get();
+            while (auto layer = dynamic_cast<const PlayerCell *>(cell)) {
+                if (layer->owner) {
+                    squaresOf(layer->owner).owned.push_back({r, c});
                 }
+                cell = layer->base.get();
             }
+            // live links are found through the link manager, but a stale
+            // occupant can only be found here
+            if (cell->isOccupied()) {
+                squaresOf(cell->getOccupantLink().player)
+                    .vacated.push_back({r, c});
+            }
+        }
+    }
+}
+
+void Board::removePlayerCells(Player *player, Game *game) {
+    AllocStats::Scope scope{AllocTag::Board};
+    auto entry = std::find_if(
+        squares.begin(), squares.end(),
+        [player](const PlayerSquares &s) { return s.owner == player; });
+    if (entry == squares.end()) return;
+
+    for (auto [r, c] : entry->owned) undecorateCell(board[r][c], player);
+
+    auto clear = [&](std::pair<int, int> coords) {
+        auto [r, c] = coords;
+        BaseCell &cell = *board[r][c];
+        if (cell.isOccupied() && cell.getOccupantLink().player == player) {
+            Log::debug("Removing a link from ", r, " ", c);
+            cell.emptyCell();
         }
+    };
+    LinkManager &links = game->getLinkManager();
+    for (unsigned id = 0; id < 8; ++id) {
+        LinkManager::LinkKey key{player, id};
+        if (links.hasLink(key)) clear(links.getLink(key).getCoords());
     }
+    for (auto coords : entry->vacated) clear(coords);
+    squares.erase(entry);
 }
 
 
-void Board::undecorateCell(std::unique_ptr<BaseCell> &cell, Player *p) {
+void Board::undecorateCell(ArenaPtr<BaseCell> &cell, Player *p) {
     if (cell == nullptr) {
         throw std::invalid_argument("Attempted to undecorate nullptr");
     }
@@ -89,17 +155,21 @@ Board::~Board() {}
 
 void Board::moveLink(std::pair<int, int> old_coords,
                      std::pair<int, int> new_coords, Game* game) {
+    static Timers::Site site{"Board::moveLink"};
+    Timers::Scope timer{site};
+    Trace::Span span{"moveLink", "engine"};
+    AllocStats::Scope scope{AllocTag::Board};
     // we truncate the y-coordinate as moving past the edge is represented by
     // moving into one of the "goal" cells.
     // Relies on the assertion that a cell on the top/bottom edges is always a
     // goal.
     new_coords.first = std::min(new_coords.first, (int)rows - 1);
     new_coords.first = std::max(new_coords.first, 0);
-    if (new_coords.first < 0 || new_coords.first > (int)board.size()) {
+    if (new_coords.first < 0 || new_coords.first >= (int)board.size()) {
         throw std::out_of_range("Move is out of bounds");
     }
     if (new_coords.second < 0 ||
-        new_coords.second > (int)board[new_coords.first].size()) {
+        new_coords.second >= (int)board[new_coords.first].size()) {
         throw std::out_of_range("Move is out of bounds");
     }
 
@@ -118,7 +188,7 @@ void Board::moveLink(std::pair<int, int> old_coords,
     game->addUpdate(oldCoordsUpdate);
     game->addUpdate(newCoordsUpdate);
 }
-std::vector<std::vector<std::unique_ptr<BaseCell>>>& Board::getBoard() {
+std::pmr::vector<std::pmr::vector<ArenaPtr<BaseCell>>>& Board::getBoard() {
     return board;
 }
 
@@ -0,0 +1,87 @@
+#include "bot.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+BotProcess::BotProcess(std::string command) : command{std::move(command)} {
+    int input[2];
+    int output[2];
+    if (pipe2(input, O_CLOEXEC) < 0) {
+        throw std::runtime_error("Cannot create pipe for " + this->command);
+    }
+    if (pipe2(output, O_CLOEXEC) < 0) {
+        close(input[0]);
+        close(input[1]);
+        throw std::runtime_error("Cannot create pipe for " + this->command);
+    }
+
+    pid = fork();
+    if (pid == 0) {
+        // dup2 clears close-on-exec on the copies the bot keeps
+        dup2(input[0], STDIN_FILENO);
+        dup2(output[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", this->command.c_str(),
+              static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    close(input[0]);
+    close(output[1]);
+    if (pid < 0) {
+        close(input[1]);
+        close(output[0]);
+        throw std::runtime_error("Cannot start " + this->command);
+    }
+    toBot = input[1];
+    fromBot = output[0];
+}
+
+BotProcess::~BotProcess() {
+    close(toBot);
+    close(fromBot);
+    // give the bot a moment to exit on its own after the end of its input
+    for (int tries = 0; tries < 20; ++tries) {
+        if (waitpid(pid, nullptr, WNOHANG) != 0) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+}
+
+const std::string &BotProcess::getCommand() const { return command; }
+
+int BotProcess::getOutputFd() const { return fromBot; }
+
+void BotProcess::send(std::string_view text) {
+    while (!text.empty()) {
+        ssize_t n = write(toBot, text.data(), text.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        text.remove_prefix(n);
+    }
+}
+
+bool BotProcess::receive(std::vector<std::string> &lines) {
+    char buffer[4096];
+    ssize_t n = read(fromBot, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) return true;
+    if (n <= 0) return false;
+    partial.append(buffer, n);
+    std::size_t start = 0;
+    for (std::size_t end; (end = partial.find('\n', start)) != std::string::npos;
+         start = end + 1) {
+        std::size_t length = end - start;
+        if (length && partial[end - 1] == '\r') --length;
+        lines.emplace_back(partial, start, length);
+    }
+    partial.erase(0, start);
+    return true;
+}
@@ -0,0 +1,66 @@
+#include <string>
+
+#include "board.h"
+#include "cell.h"
+#include "game.h"
+#include "link.h"
+#include "views.h"
+
+BotView::BotView(const Game *game, const Player *viewer) : View(game, viewer) {
+    const auto &board = game->getBoard().getBoard();
+    for (unsigned r = 0; r < board.size(); ++r) {
+        deltas += "b " + std::to_string(r) + " ";
+        for (const auto &cell : board[r]) {
+            deltas += cell->cellRepresentation(game);
+        }
+        deltas += '\n';
+    }
+
+    unsigned viewerId = game->getPlayerIndex(*viewer);
+    for (const auto &player : players) {
+        for (unsigned i = 0; i < 8; ++i) {
+            if (!game->isRevealedTo(viewerId, player.id, i)) continue;
+            const auto &link = game->getPlayerLink(player.id, i);
+            deltas += "r ";
+            deltas += char(findBase(player.id) + i);
+            deltas += link.first == Link::LinkType::DATA ? " D" : " V";
+            deltas += std::to_string(link.second) + "\n";
+        }
+    }
+    for (const auto &player : players) {
+        update(AbilityCountUpdate{player.id, unsigned(player.abilities)});
+        update(ScoreUpdate{player.id, player.score});
+    }
+}
+
+void BotView::update(View::CellUpdate update) {
+    BaseCell &cell = game->getBoard().getCell({update.row, update.col});
+    deltas += "c " + std::to_string(update.row) + " " +
+              std::to_string(update.col) + " " +
+              cell.cellRepresentation(game) + "\n";
+}
+
+void BotView::update(View::RevealLinkUpdate update) {
+    if (!game->isRevealedTo(game->getPlayerIndex(*viewer), update.playerId,
+                            update.linkId)) {
+        return;
+    }
+    deltas += "r ";
+    deltas += char(findBase(update.playerId) + update.linkId);
+    deltas += " " + update.value + "\n";
+}
+
+void BotView::update(View::AbilityCountUpdate update) {
+    deltas += "a " + std::to_string(update.playerId + 1) + " " +
+              std::to_string(update.abilityCount) + "\n";
+}
+
+void BotView::update(View::ScoreUpdate update) {
+    deltas += "s " + std::to_string(update.playerId + 1) + " " +
+              std::to_string(update.score.first) + " " +
+              std::to_string(update.score.second) + "\n";
+}
+
+std::string BotView::takeDeltas() { return std::exchange(deltas, {}); }
+
+void BotView::display() const {}
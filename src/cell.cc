@@ -7,6 +7,7 @@
 #include "link.h"
 #include "linkmanager.h"
 #include "player.h"
+#include "trace.h"
 #include "views.h"
 
 bool BaseCell::isOccupied() const { return linkKey.has_value(); }
@@ -44,6 +45,10 @@ void BoardCell::onEnter(LinkManager::LinkKey link, Game* game) {
     if (link.player == getOccupantLink().player) {
         throw std::invalid_argument("Cannot move onto own link");
     }
+    Trace::Span span{"battle", "engine"};
+    // both links are revealed to the opposing player before the battle
+    game->revealLink(link, *getOccupantLink().player);
+    game->revealLink(getOccupantLink(), *link.player);
     // handles battle, winner downloads loser and loser gets deleted
     if (game->getLinkManager().getLink(link).getStrength() >=
         game->getLinkManager().getLink(getOccupantLink()).getStrength()) {
@@ -54,7 +59,7 @@ void BoardCell::onEnter(LinkManager::LinkKey link, Game* game) {
     getOccupantLink().player->download(link);
 }
 
-PlayerCell::PlayerCell(std::unique_ptr<BaseCell> base, Player* owner)
+PlayerCell::PlayerCell(ArenaPtr<BaseCell> base, Player* owner)
     : base{std::move(base)}, owner{owner} {}
 
 void Server::onEnter(LinkManager::LinkKey link, Game* game) {
@@ -74,23 +79,8 @@ Firewall::~Firewall() = default;
 
 void Firewall::onEnter(LinkManager::LinkKey link, Game* game) {
     if (link.player != owner) {
-        if (!game->getLinkManager().getLink(link).getRevealState()) {
-            std::function<std::unique_ptr<Link>(std::unique_ptr<Link>)> fcn =
-                [](std::unique_ptr<Link> p) {
-                    return std::make_unique<RevealDecorator>(std::move(p));
-                };
-            game->getLinkManager().applyDecorator(link, fcn);
-            std::string type = game->getLinkManager().getLink(link).getType() ==
-                                       Link::LinkType::DATA
-                                   ? "D"
-                                   : "V";
-            std::string strength = std::to_string(
-                game->getLinkManager().getLink(link).getStrength());
-
-            View::RevealLinkUpdate update{game->getPlayerIndex(*link.player),
-                                          link.id, type + strength};
-            game->addUpdate(update);
-        }
+        // a link crossing a firewall is revealed to everyone
+        game->revealLinkToAll(link);
         if (game->getLinkManager().getLink(link).getType() ==
             Link::LinkType::VIRUS) {
             owner->download(link);
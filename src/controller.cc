@@ -1,18 +1,40 @@
 #include "controller.h"
 
+#include <signal.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <boost/program_options.hpp>
+#include <cerrno>
+#include <cstring>
 #include <exception>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <random>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "ability.h"
+#include "allocstats.h"
 #include "board.h"
+#include "bot.h"
+#include "eventloop.h"
+#include "framebuffer.h"
 #include "game.h"
+#include "gamestate.h"
+#include "log.h"
 #include "player.h"
+#include "replay.h"
+#include "server.h"
+#include "sharedstate.h"
+#include "timers.h"
+#include "trace.h"
+#include "tokenizer.h"
 #include "views.h"
+#include "window.h"
 
 using std::string;
 using std::vector;
@@ -45,31 +67,19 @@ void Controller::generateRandomLinks(std::vector<string> &linkList,
         link_assignments[i] = "D";
     }
 
-    std::random_device rd;
-    std::mt19937 g(rd());
-
     int max_strength = 4;
     for (int i = 0; i < placements; ++i) {
         link_assignments[i] =
             link_assignments[i] + (char)('0' + ((i % max_strength) + 1));
     }
 
-    std::shuffle(link_assignments.begin(), link_assignments.end(), g);
+    std::shuffle(link_assignments.begin(), link_assignments.end(), rng);
 
     linkList = std::move(link_assignments);
 }
 
 void Controller::init(int argc, char *argv[]) {
-    game = std::make_unique<Game>();
-    // default values
-    string ability1 = "LFDPS";
-    string ability2 = "LFDPS";
-    std::vector<string> links1;
-    std::vector<string> links2;
-    const int expected_link_placements = 8;
-    links1.reserve(expected_link_placements);
-    links2.reserve(expected_link_placements);
-    bool usingGraphics = false;
+    GameConfig config;
 
     po::options_description opts("Options");
     opts.add_options()("help,h", "Print help")(
@@ -78,7 +88,41 @@ void Controller::init(int argc, char *argv[]) {
         "link1,l1", po::value<std::string>(),
         "Link placement file for player 1.")(
         "link2,l2", po::value<string>(), "Link placement file for player 2.")(
-        "graphics,g", "Optional flag enabling graphical support.");
+        "graphics,g", "Optional flag enabling graphical support.")(
+        "frames,f", po::value<string>(),
+        "Render offscreen, writing each frame as a PPM image to this "
+        "directory.")(
+        "seed", po::value<uint64_t>(), "Seed for random link placements.")(
+        "record", po::value<string>(), "Record the game to a replay file.")(
+        "keyframes", po::value<unsigned>()->default_value(64),
+        "Turns between keyframes in a recorded replay.")(
+        "replay", po::value<string>(),
+        "Start from a replay file instead of a new game.")(
+        "seek", po::value<unsigned>(),
+        "Turn to play the replay up to; defaults to its end.")(
+        "load", po::value<string>(), "Resume a game from a save file.")(
+        "turn-time", po::value<double>(),
+        "Seconds each player has per turn; a turn that runs out passes to "
+        "the next player.")(
+        "bot1", po::value<string>(),
+        "Command that runs a bot to play player 1.")(
+        "bot2", po::value<string>(),
+        "Command that runs a bot to play player 2.")(
+        "server", po::value<string>(),
+        "Host games for clients connecting to this Unix socket.")(
+        "shm", po::value<string>(),
+        "Publish the game state to this POSIX shared memory segment as the "
+        "game is played.")(
+        "workers", po::value<unsigned>(),
+        "Worker threads for --server; defaults to one per core.")(
+        "trace", po::value<string>(),
+        "Write a Chrome trace of commands, engine phases and rendering to "
+        "this file on exit.")(
+        "log-level", po::value<string>()->default_value("warning"),
+        "Least important log messages to write: debug, info, warning, "
+        "error or off.")(
+        "log-file", po::value<string>(),
+        "Write log messages to this file instead of standard error.");
 
     auto style = po::command_line_style::default_style |
                  po::command_line_style::allow_long_disguise;
@@ -94,14 +138,44 @@ void Controller::init(int argc, char *argv[]) {
         // parse command line args
 
         if (vm.count("help")) {
-            std::cout << "Usage: " << argv[0] << "<options>\n\n"
-                      << opts << "\n";
+            out << "Usage: " << argv[0] << "<options>\n\n" << opts << "\n";
             return;
         }
 
         // raise errors for required fields
         po::notify(vm);
 
+        // logging
+        try {
+            Log::setLevel(Log::parseLevel(vm["log-level"].as<string>()));
+        } catch (const std::invalid_argument &) {
+            throw po::validation_error(
+                po::validation_error::invalid_option_value, "log-level");
+        }
+
+        if (vm.count("seed")) config.seed = vm["seed"].as<uint64_t>();
+
+        // replay
+        if (vm.count("replay")) {
+            if (vm.count("record")) {
+                throw po::error("cannot record while replaying");
+            }
+            config.replayPath = vm["replay"].as<string>();
+            if (vm.count("seek")) config.seekTurn = vm["seek"].as<unsigned>();
+        }
+        if (vm.count("record")) {
+            config.recordPath = vm["record"].as<string>();
+        }
+        config.keyframes = vm["keyframes"].as<unsigned>();
+
+        // saved game
+        if (vm.count("load")) {
+            if (vm.count("replay") || vm.count("record")) {
+                throw po::error("cannot load a save with a replay");
+            }
+            config.loadPath = vm["load"].as<string>();
+        }
+
         // player 1 abilities
         if (vm.count("ability1")) {
             auto abilities = vm["ability1"].as<string>();
@@ -110,13 +184,13 @@ void Controller::init(int argc, char *argv[]) {
                     po::validation_error::invalid_option_value,
                     "Must provide 5 abilities.", "ability1");
             }
-            ability1 = abilities;
-            std::cout << "player 1 abilities: ";
+            config.abilities[0] = abilities;
+            out << "player 1 abilities: ";
             for (auto a : abilities) {
-                std::cout << a << " ";
+                out << a << " ";
             }
         }
-        std::cout << std::endl;
+        out << std::endl;
 
         // player 2 abilities
         if (vm.count("ability2")) {
@@ -127,37 +201,71 @@ void Controller::init(int argc, char *argv[]) {
                     "Must provide 5 abilities.", "ability2");
             }
             // parse player 2 abilities
-            ability2 = abilities;
-            std::cout << "player 2 abilities: ";
+            config.abilities[1] = abilities;
+            out << "player 2 abilities: ";
             for (auto a : abilities) {
-                std::cout << a << " ";
+                out << a << " ";
             }
         }
 
         // link 1
         if (vm.count("link1")) {
-            string filename = vm["link1"].as<string>();
-            std::cout << "link 1 file: " << filename << std::endl;
-            readLinkFile(filename, links1, expected_link_placements);
-        } else {
-            // randomize link placements for player 1
-            generateRandomLinks(links1, expected_link_placements);
+            config.linkFiles[0] = vm["link1"].as<string>();
+            out << "link 1 file: " << config.linkFiles[0] << std::endl;
         }
 
         // link 2
         if (vm.count("link2")) {
-            string filename = vm["link2"].as<string>();
-            std::cout << "link 2 file: " << filename << std::endl;
-            readLinkFile(filename, links2, expected_link_placements);
-        } else {
-            // randomize link placements for player 2
-            generateRandomLinks(links2, expected_link_placements);
+            config.linkFiles[1] = vm["link2"].as<string>();
+            out << "link 2 file: " << config.linkFiles[1] << std::endl;
+        }
+
+        // turn clock
+        if (vm.count("turn-time")) {
+            double seconds = vm["turn-time"].as<double>();
+            if (!(seconds >= 0.001)) {
+                throw po::validation_error(
+                    po::validation_error::invalid_option_value, "turn-time");
+            }
+            config.turnTime = std::chrono::milliseconds{
+                static_cast<long long>(seconds * 1000)};
         }
 
         // graphics
         if (vm.count("graphics")) {
-            std::cout << "Using graphics" << std::endl;
-            usingGraphics = true;
+            out << "Using graphics" << std::endl;
+            config.graphics = true;
+        }
+
+        // offscreen frames
+        if (vm.count("frames")) {
+            config.framesDir = vm["frames"].as<string>();
+            // found now rather than when the first frame fails to write
+            std::error_code error;
+            std::filesystem::create_directories(config.framesDir, error);
+            if (error || access(config.framesDir.c_str(), W_OK) != 0) {
+                throw po::error("cannot write frames to " + config.framesDir);
+            }
+            out << "Writing frames to " << config.framesDir << std::endl;
+            config.graphics = true;
+        }
+
+        // bots
+        if (vm.count("bot1")) config.bots[0] = vm["bot1"].as<string>();
+        if (vm.count("bot2")) config.bots[1] = vm["bot2"].as<string>();
+
+        // shared memory
+        if (vm.count("shm")) config.shmName = vm["shm"].as<string>();
+
+        // server; every session plays a fresh game with these settings
+        if (vm.count("server")) {
+            for (auto option : {"graphics", "frames", "record", "replay",
+                                "load", "turn-time", "bot1", "bot2", "shm"}) {
+                if (vm.count(option)) {
+                    throw po::error(string{"--"} + option +
+                                    " cannot be used with --server");
+                }
+            }
         }
 
     } catch (const po::error &e) {
@@ -165,125 +273,601 @@ void Controller::init(int argc, char *argv[]) {
         throw std::invalid_argument("");
     }
 
+    if (vm.count("log-file")) {
+        Log::setSink(std::make_shared<FileSink>(vm["log-file"].as<string>()));
+    }
+    if (vm.count("trace")) Trace::start(vm["trace"].as<string>());
+
+    if (vm.count("server")) {
+        unsigned workers = vm.count("workers")
+                               ? vm["workers"].as<unsigned>()
+                               : std::thread::hardware_concurrency();
+        GameServer server{config, vm["server"].as<string>(),
+                          std::max(workers, 1u)};
+        server.run();
+        return;
+    }
+
+    start(config);
+    runGameLoop();
+}
+
+void Controller::start(const GameConfig &config) {
+    game = GamePool::local().acquire();
+    game->setOutput(out);
     const unsigned nPlayers = 2;
+    const int expected_link_placements = 8;
 
-    std::vector<string> allAbilities = {ability1, ability2};
-    std::vector<std::vector<string>> allLinkPlacements = {links1, links2};
+    // seed first, so random placements can be reproduced
+    seed = config.seed ? *config.seed : std::random_device{}();
+    fileCommands = config.fileCommands;
+    rng.seed(seed);
 
-    game->startGame(nPlayers, allAbilities, allLinkPlacements);
+    if (!config.replayPath.empty()) {
+        replay = std::make_unique<ReplayReader>(config.replayPath);
+        if (replay->getHeader().abilities.size() != nPlayers) {
+            throw std::invalid_argument("Replay is not a two player game");
+        }
+    }
+    if (!config.loadPath.empty()) {
+        saved = std::make_unique<GameState>(GameState::load(config.loadPath));
+        if (saved->playerCount != nPlayers) {
+            throw std::invalid_argument("Save is not a two player game");
+        }
+    }
 
-    for (auto player : game->getPlayers()) {
-        auto text_view = std::make_unique<TextView>(game.get(), player);
-        views[player].push_back(std::move(text_view));
+    std::vector<string> allAbilities = config.abilities;
+    std::vector<std::vector<string>> allLinkPlacements(nPlayers);
+    for (unsigned i = 0; i < nPlayers; ++i) {
+        auto &links = allLinkPlacements[i];
+        links.reserve(expected_link_placements);
+        if (!config.linkFiles[i].empty()) {
+            readLinkFile(config.linkFiles[i], links, expected_link_placements);
+        } else {
+            // randomize link placements
+            generateRandomLinks(links, expected_link_placements);
+        }
+    }
+    if (replay) {
+        allAbilities = replay->getHeader().abilities;
+        allLinkPlacements = replay->getHeader().placements;
+    }
+    if (saved) {
+        // the saved state replaces the links and abilities wholesale
+        for (unsigned i = 0; i < nPlayers; ++i) {
+            const auto &ps = saved->players[i];
+            allAbilities[i].assign(ps.abilities, ps.abilityCount);
+        }
+    }
+
+    game->reset(nPlayers, allAbilities, allLinkPlacements);
+
+    if (replay) {
+        unsigned target =
+            config.seekTurn.value_or(std::numeric_limits<unsigned>::max());
+        unsigned reached = replay->seek(*game, target);
+        out << "Replayed to turn " << reached << std::endl;
     }
+    if (saved) {
+        saved->restore(*game);
+        out << "Loaded turn " << game->getTurn() << std::endl;
+        saved.reset();
+    }
+    if (!config.recordPath.empty()) {
+        ReplayHeader header{seed, config.keyframes, allAbilities,
+                            allLinkPlacements};
+        recorder = std::make_unique<ReplayWriter>(config.recordPath, header);
+    }
+    turnTime = config.turnTime;
+
+    bots.resize(nPlayers);
+    if (std::any_of(config.bots.begin(), config.bots.end(),
+                    [](const string &command) { return !command.empty(); })) {
+        // a bot that exits must not take the arbiter down with it
+        signal(SIGPIPE, SIG_IGN);
+    }
+    for (unsigned i = 0; i < nPlayers && i < config.bots.size(); ++i) {
+        if (config.bots[i].empty()) continue;
+        bots[i].process = std::make_unique<BotProcess>(config.bots[i]);
+        bots[i].process->send("player " + std::to_string(i + 1) + "\n");
+        out << "Player " << i + 1 << " is played by " << config.bots[i]
+            << std::endl;
+    }
+
+    buildViews();
     gameIsRunning = true;
 
-    if (usingGraphics) {
-        graphicsView = std::make_unique<GraphicsView>(game.get());
+    if (!config.shmName.empty()) {
+        publisher = std::make_unique<StatePublisher>(config.shmName);
+        out << "Publishing state to " << publisher->getName() << std::endl;
+        publishState();
     }
-    std::cout << "Starting game\n";
-    std::cout << "Player 1's turn. Waiting for command...\n";
 
-    runGameLoop();
+    usingGraphics = config.graphics;
+    framesDir = config.framesDir;
+    if (usingGraphics) {
+        std::unique_ptr<RenderBackend> backend;
+        if (!framesDir.empty()) {
+            backend = std::make_unique<Framebuffer>(1000, 700, framesDir);
+        } else {
+            try {
+                backend = std::make_unique<Xwindow>(1000, 700);
+            } catch (const std::runtime_error &e) {
+                std::cerr << e.what() << ", continuing without graphics\n";
+                usingGraphics = false;
+            }
+        }
+        if (backend) {
+            graphicsView =
+                std::make_unique<GraphicsView>(game.get(), std::move(backend));
+        }
+    }
+    out << "Starting game\n";
+    out << "Player " << game->getPlayerIndex(*game->getCurrentPlayer()) + 1 << "'s turn. Waiting for command...\n";
 }
 
 void Controller::runGameLoop() {
-    while (gameIsRunning) {
-        string s;
-        std::getline(std::cin, s);
-        parseCommand(s);
-        updateViews();
+    loop = std::make_unique<EventLoop>();
+    loop->watch(STDIN_FILENO, [this] { onInput(); });
+    if (turnTime.count() > 0) {
+        turnClock = std::make_unique<Timer>();
+        loop->watch(turnClock->getFd(), [this] { onTurnTimeout(); });
+        armTurnClock();
+    }
+    for (unsigned i = 0; i < bots.size(); ++i) {
+        if (!bots[i].process) continue;
+        loop->watch(bots[i].process->getOutputFd(),
+                    [this, i] { onBotOutput(i); });
     }
+    promptBots();
+    out << std::flush;
+    loop->run();
 }
 
-void Controller::parseCommand(const std::string &commandLine) {
-    std::stringstream ss(commandLine);
-    string command;
-    ss >> command;
+void Controller::onInput() {
+    // a line longer than the buffer: make room for the rest of it
+    if (inputFilled == input.size()) {
+        input.resize(std::max(input.size() * 2, inputChunk));
+    }
+    ssize_t n = read(STDIN_FILENO, input.data() + inputFilled,
+                     input.size() - inputFilled);
+    if (n < 0 && errno == EINTR) return;
+    bool eof = n <= 0;
+    if (n > 0) inputFilled += n;
+
+    size_t start = 0;
+    while (gameIsRunning && start < inputFilled) {
+        const char *begin = input.data() + start;
+        const void *newline = std::memchr(begin, '\n', inputFilled - start);
+        if (!newline) {
+            // keep a partial line for the next read unless input is done
+            if (!eof) break;
+            runCommands({begin, inputFilled - start});
+            start = inputFilled;
+            break;
+        }
+        size_t length = static_cast<const char *>(newline) - begin;
+        runCommands({begin, length});
+        start += length + 1;
+    }
+    std::memmove(input.data(), input.data() + start, inputFilled - start);
+    inputFilled -= start;
 
-    if (command == "quit") {
-        gameIsRunning = false;
-    } else if (command == "move") {
-        char link, direction;
-        ss >> link >> direction;
-        unsigned id;
-        if (link <= 'Z') {
-            id = link - 'A';
+    if (eof) {
+        // bots play on without an operator
+        if (hasBots()) {
+            loop->unwatch(STDIN_FILENO);
         } else {
-            id = link - 'a';
+            gameIsRunning = false;
         }
+    }
+    // piped input arrives in large blocks; the views catch up once per block
+    settle();
+}
 
-        game->makeMove(id, direction);
-        clearStdout();
-        graphicsView->nextTurn();
-        std::cout << "Player " << game->getPlayerIndex(*game->getCurrentPlayer()) + 1 << "'s turn. Waiting for command...\n";
+void Controller::onTurnTimeout() {
+    if (!turnClock->consume()) return;
+    unsigned current = game->getPlayerIndex(*game->getCurrentPlayer());
+    if (current < bots.size() && bots[current].process) {
+        forfeit(current, "ran out of time");
+    } else {
+        out << "Player " << current + 1 << " ran out of time.\n";
+        game->nextTurn();
+        if (recorder) recorder->recordPass(*game);
+        checkGameOver();
+        if (gameIsRunning) {
+            out << "Player "
+                << game->getPlayerIndex(*game->getCurrentPlayer()) + 1
+                << "'s turn. Waiting for command...\n";
+        }
+    }
+    settle();
+}
 
-        // game->printGameInfo();
+void Controller::onBotOutput(unsigned player) {
+    Bot &bot = bots[player];
+    std::vector<string> lines;
+    if (!bot.process->receive(lines)) {
+        loop->unwatch(bot.process->getOutputFd());
+        if (gameIsRunning) forfeit(player, "exited");
+    }
+    for (const auto &line : lines) {
+        if (!gameIsRunning) break;
+        // replies that arrive after the bot's turn has ended are dropped
+        unsigned current = game->getPlayerIndex(*game->getCurrentPlayer());
+        if (!bot.toMove || current != player) continue;
+        bot.toMove = false;
+        out << "Player " << player + 1 << ": " << line << "\n";
+        Tokenizer tokens{line};
+        std::string_view word = tokens.next();
+        if (word != "move" && word != "ability") {
+            out << "Bots may only move and use abilities.\n";
+            continue;
+        }
+        parseCommand(line);
+    }
+    settle();
+}
+
+void Controller::settle() {
+    updateViews();
+    publishState();
+    if (turnClock && gameIsRunning && game->getTurn() != clockTurn) {
+        armTurnClock();
+    }
+    promptBots();
+    if (!gameIsRunning) loop->stop();
+    out << std::flush;
+}
+
+bool Controller::hasBots() const {
+    return std::any_of(bots.begin(), bots.end(),
+                       [](const Bot &bot) { return bot.process != nullptr; });
+}
 
-    } else if (command == "abilities") {
-        auto &abilities = game->getCurrentPlayer()->getAbilities();
-        std::cout << "Available abilities:\n";
-        for (auto &ability : abilities) {
-            if (!ability->isUsed()) {
-                std::cout << ability->getName() << std::endl;
+void Controller::promptBots() {
+    Trace::Span span{"promptBots", "bots"};
+    unsigned current = game->getPlayerIndex(*game->getCurrentPlayer());
+    for (unsigned i = 0; i < bots.size(); ++i) {
+        Bot &bot = bots[i];
+        if (!bot.process) continue;
+        string message = bot.view ? bot.view->takeDeltas() : "";
+        if (!gameIsRunning) {
+            message += winner < 0              ? "end\n"
+                       : winner == int(i)      ? "end win\n"
+                                               : "end loss\n";
+        } else if (i == current) {
+            if (!bot.toMove) {
+                message += "go";
+                if (turnClock) {
+                    auto left = std::chrono::duration_cast<
+                        std::chrono::milliseconds>(
+                        turnDeadline - std::chrono::steady_clock::now());
+                    message += " " + std::to_string(
+                                         std::max<long long>(left.count(), 0));
+                }
+                message += "\n";
+                bot.toMove = true;
+            }
+        } else {
+            // the turn may have been taken from the bot by the operator
+            bot.toMove = false;
+            if (bot.ponderTurn != game->getTurn()) {
+                message += "ponder\n";
+                bot.ponderTurn = game->getTurn();
             }
         }
-    } else if (command == "ability") {
-        vector<string> params;
-        string arg;
-        int abilityID;
-        ss >> abilityID;
-        while (ss >> arg) {
-            params.push_back(arg);
-        }
+        if (!message.empty()) bot.process->send(message);
+    }
+}
 
-        auto &abilities = game->getCurrentPlayer()->getAbilities();
-        try {
-            abilities.at(abilityID - 1)->use(*game, params);
-        } catch (std::exception &e) {
-            std::cout << "Invalid ability usage: " << e.what() << "\n";
+void Controller::forfeit(unsigned player, std::string_view reason) {
+    out << "Player " << player + 1 << "'s bot " << reason << ".\n";
+    for (unsigned i = 0; i < bots.size(); ++i) {
+        if (i != player && game->getPlayers()[i]) winner = i;
+    }
+    if (winner >= 0) out << "Player " << winner + 1 << " Wins!\n";
+    gameIsRunning = false;
+}
+
+void Controller::armTurnClock() {
+    if (!turnClock) return;
+    clockTurn = game->getTurn();
+    turnDeadline = std::chrono::steady_clock::now() + turnTime;
+    turnClock->arm(turnTime);
+}
+
+void Controller::runCommands(std::string_view line) {
+    if (line.find(';') == std::string_view::npos) {
+        parseCommand(line);
+        return;
+    }
+    while (gameIsRunning) {
+        size_t end = line.find(';');
+        std::string_view command = line.substr(0, end);
+        // tolerate empty commands such as a trailing ';'
+        if (command.find_first_not_of(" \t\r") != std::string_view::npos) {
+            parseCommand(command);
         }
-    } else if (command == "board") {
-        display();
-        // game->printGameInfo();
-    } else if (command == "sequence") {
-        string file;
-        ss >> file;
-        std::ifstream commandFile(file);
-        if (!commandFile) {
-            std::cout << "Command file not found.\n";
-        } else {
-            while (commandFile) {
-                string line;
-                std::getline(commandFile, line);
-                parseCommand(line);
-            }
+        if (end == std::string_view::npos) break;
+        line.remove_prefix(end + 1);
+    }
+}
+
+constexpr std::array<Controller::Command, Controller::commandSlots>
+Controller::makeCommandTable() {
+    std::array<Command, commandSlots> table{};
+    const Command entries[] = {
+        {"quit", &Controller::quitCommand},
+        {"move", &Controller::moveCommand},
+        {"abilities", &Controller::abilitiesCommand},
+        {"ability", &Controller::abilityCommand},
+        {"board", &Controller::boardCommand},
+        {"sequence", &Controller::sequenceCommand, true},
+        {"comment", &Controller::commentCommand},
+        {"gupdate", &Controller::gupdateCommand},
+        {"save", &Controller::saveCommand, true},
+        {"load", &Controller::loadCommand, true},
+        {"stats", &Controller::statsCommand},
+    };
+    for (const auto &entry : entries) {
+        auto &slot = table[commandHash(entry.name)];
+        if (slot.handler) {
+            // not a constant expression, so a collision fails the build
+            throw std::logic_error("command hash collision");
         }
-    } else if (command == "comment") {
-        // do nothing; this simply allows for comments in test files run by
-        // sequence.
-    } else if (command == "gupdate") {
-        if (graphicsView) {
-            graphicsView->realdisplay();
+        slot = entry;
+    }
+    return table;
+}
+
+constexpr std::array<Controller::Command, Controller::commandSlots>
+    Controller::commands = makeCommandTable();
+
+void Controller::parseCommand(std::string_view commandLine) {
+    static Timers::Site site{"Controller::parseCommand"};
+    Timers::Scope timer{site};
+    AllocStats::Scope scope{AllocTag::Parsing};
+    Tokenizer tokens{commandLine};
+    std::string_view word = tokens.next();
+
+    const Command &command = commands[commandHash(word)];
+    if (command.handler && command.name == word) {
+        if (command.namesFiles && !fileCommands) {
+            out << "Files cannot be used in this game.\n";
         } else {
-            std::cout << "Not using graphics.\n";
+            Trace::Span span{command.name, "command"};
+            (this->*command.handler)(tokens);
         }
     } else {
-        std::cout << "Command not found.\n";
+        out << "Command not found.\n";
     }
 
-    if (game->checkWinLoss()) {
-        auto playerid = game->getPlayerIndex(*game->getCurrentPlayer()) + 1;
-        std::cout << "Player " << playerid << " Wins!\n";
+    checkGameOver();
+}
+
+void Controller::checkGameOver() {
+    if (Player *won = game->checkWinLoss()) {
+        // the winner need not be the player to move, as when a download
+        // takes an opponent's fourth data
+        winner = game->getPlayerIndex(*won);
+        out << "Player " << winner + 1 << " Wins!\n";
         // game->printGameInfo();
         display();
         gameIsRunning = false;
     }
 }
 
+void Controller::publishState() {
+    AllocStats::Scope scope{AllocTag::Publish};
+    if (publisher) publisher->publish(*game);
+}
+
+void Controller::quitCommand(Tokenizer &args) {
+    if (Timers::enabled) Timers::print(out);
+    gameIsRunning = false;
+}
+
+void Controller::moveCommand(Tokenizer &args) {
+    try {
+        std::string_view link = args.next();
+        std::string_view direction = args.next();
+        if (link.empty() || direction.empty()) {
+            throw std::invalid_argument("Expected a link and a direction");
+        }
+        unsigned id;
+        if (link[0] <= 'Z') {
+            id = link[0] - 'A';
+        } else {
+            id = link[0] - 'a';
+        }
+        Link::Direction dir = Link::charToDirection(direction[0]);
+        game->makeMove(id, dir);
+        if (recorder) recorder->recordMove(*game, id, dir);
+    } catch (std::exception &e) {
+        out << "Invalid command: " << e.what() << std::endl;
+    }
+    clearStdout();
+    out << "Player " << game->getPlayerIndex(*game->getCurrentPlayer()) + 1 << "'s turn. Waiting for command...\n";
+
+    // game->printGameInfo();
+}
+
+void Controller::abilitiesCommand(Tokenizer &args) {
+    auto &abilities = game->getCurrentPlayer()->getAbilities();
+    out << "Available abilities:\n";
+    for (auto &ability : abilities) {
+        if (!ability->isUsed()) {
+            out << ability->getName() << std::endl;
+        }
+    }
+}
+
+void Controller::abilityCommand(Tokenizer &args) {
+    int abilityID = 0;
+    bool validID = args.nextInt(abilityID);
+    AbilityArgs params;
+    for (std::string_view arg = args.next(); !arg.empty(); arg = args.next()) {
+        if (params.count < AbilityArgs::maxArgs) {
+            // "abc" is not link a
+            params.linkIds[params.count] = arg.size() == 1 ? arg[0] : 0;
+            params.numeric[params.count] =
+                Tokenizer::toInt(arg, params.values[params.count]);
+        }
+        ++params.count;
+    }
+
+    try {
+        if (!validID) {
+            throw std::invalid_argument("Expected an ability number");
+        }
+        game->useAbility(abilityID, params);
+        if (recorder) recorder->recordAbility(abilityID, params);
+    } catch (std::exception &e) {
+        out << "Invalid ability usage: " << e.what() << "\n";
+    }
+}
+
+void Controller::boardCommand(Tokenizer &args) {
+    display();
+    // game->printGameInfo();
+}
+
+void Controller::sequenceCommand(Tokenizer &args) {
+    const Script *script;
+    try {
+        string path = ScriptCache::resolve(args.next());
+        if (std::find(activeScripts.begin(), activeScripts.end(), path) !=
+            activeScripts.end()) {
+            out << "Sequence file " << path
+                      << " includes itself; skipping.\n";
+            return;
+        }
+        script = &scripts.get(path);
+    } catch (const std::invalid_argument &e) {
+        out << "Command file not found.\n";
+        return;
+    }
+
+    activeScripts.push_back(script->getPath());
+    for (std::string_view command : script->getCommands()) {
+        if (!gameIsRunning) break;
+        parseCommand(command);
+    }
+    activeScripts.pop_back();
+}
+
+void Controller::setSeatOutput(unsigned player, std::ostream &stream) {
+    if (seatOutputs.size() <= player) seatOutputs.resize(player + 1);
+    seatOutputs[player] = &stream;
+}
+
+bool Controller::isRunning() const { return gameIsRunning; }
+
+const Game &Controller::getGame() const { return *game; }
+
+bool Controller::inSequence() const { return !activeScripts.empty(); }
+
+void Controller::commentCommand(Tokenizer &args) {
+    // do nothing; this simply allows for comments in test files run by
+    // sequence.
+}
+
+void Controller::gupdateCommand(Tokenizer &args) {
+    if (graphicsView) {
+        if (inSequence()) return;
+        updateViews();
+        graphicsView->realdisplay();
+    } else {
+        out << "Not using graphics.\n";
+    }
+}
+
+void Controller::saveCommand(Tokenizer &args) {
+    try {
+        std::string_view path = args.next();
+        if (path.empty()) {
+            throw std::invalid_argument("Expected a file name");
+        }
+        GameState::capture(*game).save(string{path});
+        out << "Saved turn " << game->getTurn() << " to " << path
+                  << ".\n";
+    } catch (const std::exception &e) {
+        out << "Cannot save: " << e.what() << "\n";
+    }
+}
+
+void Controller::loadCommand(Tokenizer &args) {
+    try {
+        std::string_view path = args.next();
+        if (path.empty()) {
+            throw std::invalid_argument("Expected a file name");
+        }
+        if (recorder) {
+            // the replay could not reproduce a jump to another game
+            throw std::invalid_argument("a replay is being recorded");
+        }
+        GameState::load(string{path}).restore(*game);
+    } catch (const std::exception &e) {
+        out << "Cannot load: " << e.what() << "\n";
+        return;
+    }
+    // players may have been replaced, so the views start over
+    buildViews();
+    if (graphicsView) graphicsView->reload();
+    armTurnClock();
+    out << "Loaded turn " << game->getTurn() << ". Player "
+              << game->getPlayerIndex(*game->getCurrentPlayer()) + 1
+              << "'s turn. Waiting for command...\n";
+}
+
+void Controller::statsCommand(Tokenizer &args) {
+    AllocStats::print(out);
+    out << "Game arena: " << game->getArenaOverflow()
+        << " bytes on the heap beyond its buffer\n";
+    Timers::print(out);
+}
+
+void Controller::buildViews() {
+    AllocStats::Scope scope{AllocTag::Views};
+    views.clear();
+    auto players = game->getPlayers();
+    for (unsigned i = 0; i < players.size(); ++i) {
+        Player *player = players[i];
+        if (!player) continue;
+        std::ostream &viewOut = i < seatOutputs.size() && seatOutputs[i]
+                                    ? *seatOutputs[i]
+                                    : out;
+        auto text_view =
+            std::make_unique<TextView>(game.get(), player, viewOut);
+        views[player].push_back(std::move(text_view));
+        if (i < bots.size() && bots[i].process) {
+            // a new view starts with a snapshot that replaces the bot's
+            // picture of the game
+            auto bot_view = std::make_unique<BotView>(game.get(), player);
+            bots[i].view = bot_view.get();
+            views[player].push_back(std::move(bot_view));
+        }
+    }
+}
+
 void Controller::updateViews() {
+    Trace::Span span{"updateViews", "views"};
+    static Timers::Site site{"Controller::updateViews"};
+    Timers::Scope timer{site};
+    AllocStats::Scope scope{AllocTag::Views};
     auto q = game->flushUpdates();
 
+    // an eliminated player's views would still point at the deleted player
+    auto players = game->getPlayers();
+    std::erase_if(views, [&](const auto &entry) {
+        return std::find(players.begin(), players.end(), entry.first) ==
+               players.end();
+    });
+    for (unsigned i = 0; i < bots.size() && i < players.size(); ++i) {
+        if (!players[i]) bots[i].view = nullptr;
+    }
+
     while (!q.empty()) {
         const auto &update = q.front();
         std::visit([&](auto &&x) { 
@@ -301,24 +885,28 @@ void Controller::updateViews() {
         }
         q.pop();
     }
-    if (usingGraphics) {
+    // scripted scenarios only draw once they are done
+    if (usingGraphics && !inSequence()) {
         graphicsView->refresh();
     }
 }
 
 void Controller::display() {
+    AllocStats::Scope scope{AllocTag::Views};
+    // views may be behind while input is being pipelined
+    updateViews();
     auto pl = game->getCurrentPlayer();
     for (auto &i : views[pl]) {
         i->display();
     }
-    if (usingGraphics) {
+    if (usingGraphics && !inSequence()) {
         graphicsView->realdisplay();
     }
 }
 
 void Controller::clearStdout() {
-    std::cout << "\x1B[2J\x1B[H";  // escape sequences that clear & move cursor
+    out << "\x1B[2J\x1B[H";  // escape sequences that clear & move cursor
 }
 
-Controller::Controller() {}
+Controller::Controller(std::ostream &out) : out{out} {}
 Controller::~Controller() {}
@@ -0,0 +1,152 @@
+#include "eventloop.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+
+EventLoop::EventLoop() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        throw std::runtime_error("Cannot create epoll instance");
+    }
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeFd;
+    if (wakeFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) < 0) {
+        if (wakeFd >= 0) close(wakeFd);
+        close(epollFd);
+        throw std::runtime_error("Cannot create event loop wakeup");
+    }
+}
+
+EventLoop::~EventLoop() {
+    close(wakeFd);
+    close(epollFd);
+}
+
+void EventLoop::watch(int fd, std::function<void()> onReady) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        // regular files and /dev/null are always readable and epoll refuses
+        // them, so they are polled on every pass instead
+        if (errno != EPERM) {
+            throw std::runtime_error("Cannot watch file descriptor");
+        }
+        alwaysReady.push_back(fd);
+    }
+    handlers[fd] = std::move(onReady);
+}
+
+void EventLoop::unwatch(int fd) {
+    if (!handlers.erase(fd)) return;
+    auto ready = std::find(alwaysReady.begin(), alwaysReady.end(), fd);
+    if (ready != alwaysReady.end()) {
+        alwaysReady.erase(ready);
+    } else {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+void EventLoop::setWritable(int fd, bool wantWrite) {
+    epoll_event event{};
+    event.events = wantWrite ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void EventLoop::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock{postedMutex};
+        posted.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    write(wakeFd, &one, sizeof(one));
+}
+
+void EventLoop::runPosted() {
+    uint64_t count;
+    read(wakeFd, &count, sizeof(count));
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock{postedMutex};
+        tasks.swap(posted);
+    }
+    for (auto &task : tasks) {
+        if (!running) break;
+        task();
+    }
+}
+
+void EventLoop::run() {
+    running = true;
+    constexpr int maxEvents = 16;
+    epoll_event events[maxEvents];
+    while (running) {
+        int timeout = alwaysReady.empty() ? -1 : 0;
+        int n = epoll_wait(epollFd, events, maxEvents, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("epoll_wait failed");
+        }
+        for (int i = 0; i < n && running; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                runPosted();
+                continue;
+            }
+            // a handler may unwatch itself or an fd later in this batch
+            auto handler = handlers.find(fd);
+            if (handler == handlers.end()) continue;
+            auto onReady = handler->second;
+            onReady();
+        }
+        std::vector<int> ready = alwaysReady;
+        for (int fd : ready) {
+            if (!running) break;
+            auto handler = handlers.find(fd);
+            if (handler == handlers.end()) continue;
+            auto onReady = handler->second;
+            onReady();
+        }
+    }
+}
+
+void EventLoop::stop() { running = false; }
+
+Timer::Timer() {
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create timer");
+    }
+}
+
+Timer::~Timer() { close(fd); }
+
+int Timer::getFd() const { return fd; }
+
+void Timer::arm(std::chrono::milliseconds delay) {
+    itimerspec spec{};
+    spec.it_value.tv_sec = delay.count() / 1000;
+    spec.it_value.tv_nsec = (delay.count() % 1000) * 1000000;
+    timerfd_settime(fd, 0, &spec, nullptr);
+}
+
+void Timer::disarm() {
+    itimerspec spec{};
+    timerfd_settime(fd, 0, &spec, nullptr);
+}
+
+bool Timer::consume() {
+    uint64_t expirations;
+    return read(fd, &expirations, sizeof(expirations)) ==
+           sizeof(expirations);
+}
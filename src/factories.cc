@@ -6,39 +6,41 @@
 #include "ability.h"
 #include "link.h"
 
-std::unique_ptr<Ability> AbilityFactory::createPlayerAbility(char id) {
+ArenaPtr<Ability> AbilityFactory::createPlayerAbility(
+    char id, std::pmr::memory_resource* arena) {
     switch (id) {
         case 'F':
-            return std::make_unique<FirewallAbility>();
+            return makeArena<FirewallAbility>(arena);
         case 'D':
-            return std::make_unique<DownloadAbility>();
+            return makeArena<DownloadAbility>(arena);
         case 'L':
-            return std::make_unique<LinkBoostAbility>();
+            return makeArena<LinkBoostAbility>(arena);
         case 'P':
-            return std::make_unique<PolarizeAbility>();
+            return makeArena<PolarizeAbility>(arena);
         case 'S':
-            return std::make_unique<ScanAbility>();
+            return makeArena<ScanAbility>(arena);
         case 'Q':
-            return std::make_unique<QuantumEntanglementAbility>();
+            return makeArena<QuantumEntanglementAbility>(arena);
         case 'W':
-            return std::make_unique<WormHoleAbility>();
+            return makeArena<WormHoleAbility>(arena);
         case 'p':
-            return std::make_unique<PappleAbility>();
+            return makeArena<PappleAbility>(arena);
         default:
             throw std::invalid_argument("Invalid ability id");
     }
 }
 
-std::unique_ptr<Link> LinkFactory::createLink(std::string id,
-                                              std::pair<int, int> startCoords,
-                                              Player* owner, Board* board) {
+ArenaPtr<Link> LinkFactory::createLink(std::string id,
+                                       std::pair<int, int> startCoords,
+                                       Player* owner, Board* board,
+                                       std::pmr::memory_resource* arena) {
     switch (id[0]) {
         case 'V':
-            return std::make_unique<VirusLink>(startCoords, id[1] - '0', owner,
-                                               board);
+            return makeArena<VirusLink>(arena, startCoords, id[1] - '0', owner,
+                                        board);
         case 'D':
-            return std::make_unique<DataLink>(startCoords, id[1] - '0', owner,
-                                              board);
+            return makeArena<DataLink>(arena, startCoords, id[1] - '0', owner,
+                                       board);
         default:
             throw std::invalid_argument("Invalid link id");
     }
@@ -0,0 +1,216 @@
+#include "framebuffer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Same palette as the X11 window
+const uint32_t palette[10] = {
+    0xFFFFFF,  // White
+    0x000000,  // Black
+    0xFF6B6B,  // lRed
+    0x8B0000,  // dRed
+    0x90EE90,  // lGreen
+    0x006400,  // dGreen
+    0xADD8E6,  // lBlue
+    0x00008B,  // dBlue
+    0xD8BFD8,  // lPurple
+    0x4B0082   // dPurple
+};
+
+// 5x7 glyphs for printable ASCII (' ' to '~'), one byte per column, least
+// significant bit at the top.
+const unsigned char font[95][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00},
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00},
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00},
+    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08},
+    {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31},
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39},
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E},
+    {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00},
+    {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06},
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E},
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41},
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x49, 0x49, 0x7A},
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x0C, 0x02, 0x7F},
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E},
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31},
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x07, 0x08, 0x70, 0x08, 0x07},
+    {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00},
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+    {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20},
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18},
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00},
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, {0x08, 0x14, 0x14, 0x18, 0x7C},
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C},
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+    {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00},
+    {0x08, 0x04, 0x08, 0x10, 0x08}};
+
+}  // namespace
+
+Framebuffer::Framebuffer(int width, int height, std::string outputDir)
+    : width{width},
+      height{height},
+      pixels(width * height, palette[White]),
+      outputDir{std::move(outputDir)} {}
+
+int Framebuffer::getWidth() const { return width; }
+int Framebuffer::getHeight() const { return height; }
+
+void Framebuffer::fillRectangle(int x, int y, int width, int height,
+                                int colour) {
+    // clip to the buffer
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = std::min(x + width, this->width);
+    int y1 = std::min(y + height, this->height);
+    for (int r = y0; r < y1; ++r) {
+        std::fill(pixels.begin() + r * this->width + x0,
+                  pixels.begin() + r * this->width + x1, palette[colour]);
+    }
+}
+
+void Framebuffer::drawString(int x, int y, const std::string &msg) {
+    // glyphs sit on the baseline like the X11 "fixed" font, 6px apart
+    for (char ch : msg) {
+        if (ch >= ' ' && ch <= '~') {
+            const unsigned char *glyph = font[ch - ' '];
+            for (int col = 0; col < 5; ++col) {
+                for (int row = 0; row < 7; ++row) {
+                    if (glyph[col] & (1 << row)) {
+                        fillRectangle(x + col, y - 7 + row, 1, 1, Black);
+                    }
+                }
+            }
+        }
+        x += 6;
+    }
+}
+
+void Framebuffer::drawLine(int x1, int y1, int x2, int y2, int thickness,
+                           int colour) {
+    // square brush centred on the line, like a wide X11 line
+    int half = thickness / 2;
+    if (x1 == x2 || y1 == y2) {
+        int x = std::min(x1, x2) - half;
+        int y = std::min(y1, y2) - half;
+        fillRectangle(x, y, std::abs(x2 - x1) + thickness,
+                      std::abs(y2 - y1) + thickness, colour);
+        return;
+    }
+
+    // Bresenham for everything else
+    int dx = std::abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -std::abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+        fillRectangle(x1 - half, y1 - half, thickness, thickness, colour);
+        if (x1 == x2 && y1 == y2) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x1 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+void Framebuffer::queueRectangle(int x, int y, int width, int height,
+                                 int colour) {
+    rectQueue.push_back({x, y, width, height, colour});
+}
+
+void Framebuffer::queueLine(int x1, int y1, int x2, int y2, int thickness,
+                            int colour) {
+    lineQueue.push_back({x1, y1, x2, y2, thickness, colour});
+}
+
+void Framebuffer::flushBatch() {
+    for (const auto &r : rectQueue) {
+        fillRectangle(r.x, r.y, r.width, r.height, r.colour);
+    }
+    for (const auto &l : lineQueue) {
+        drawLine(l.x1, l.y1, l.x2, l.y2, l.thickness, l.colour);
+    }
+    rectQueue.clear();
+    lineQueue.clear();
+}
+
+void Framebuffer::display() {
+    framePending = true;
+    flush();
+}
+
+void Framebuffer::displayArea(int x, int y, int width, int height) {
+    framePending = true;
+}
+
+void Framebuffer::flush() {
+    if (!framePending) return;
+    framePending = false;
+    ++frameCount;
+    writeFrame();
+}
+
+bool Framebuffer::isInteractive() const { return false; }
+
+unsigned Framebuffer::getFrameCount() const { return frameCount; }
+
+const std::vector<uint32_t> &Framebuffer::getPixels() const { return pixels; }
+
+void Framebuffer::writeFrame() {
+    if (outputDir.empty()) return;
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%06u.ppm", frameCount);
+    writePPM(outputDir + name);
+}
+
+void Framebuffer::writePPM(const std::string &filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot write frame " + filename);
+    }
+    out << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<unsigned char> row(width * 3);
+    for (int r = 0; r < height; ++r) {
+        for (int c = 0; c < width; ++c) {
+            uint32_t p = pixels[r * width + c];
+            row[c * 3] = p >> 16;
+            row[c * 3 + 1] = (p >> 8) & 0xFF;
+            row[c * 3 + 2] = p & 0xFF;
+        }
+        out.write(reinterpret_cast<const char *>(row.data()), row.size());
+    }
+}
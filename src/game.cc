@@ -6,12 +6,16 @@
 #include <tuple>
 
 #include "ability.h"
+#include "allocstats.h"
 #include "board.h"
 #include "cell.h"
 #include "factories.h"
 #include "link.h"
 #include "linkmanager.h"
+#include "log.h"
 #include "player.h"
+#include "timers.h"
+#include "trace.h"
 
 using LinkKey = LinkManager::LinkKey;
 typedef std::variant<std::pair<int, int>, std::tuple<int, int, std::string>>
@@ -20,30 +24,36 @@ typedef std::variant<std::pair<int, int>, std::tuple<int, int, std::string>>
 void Game::startGame(
     unsigned nPlayers, const std::vector<std::string>& abilities,
     const std::vector<std::vector<std::string>>& linkPlacements) {
-    linkManager = std::make_shared<LinkManager>();
+    linkManager = makeArena<LinkManager>(&arena, &arena);
     // create board
-    board = std::make_unique<Board>(10, 8);
+    board = makeArena<Board>(&arena, 10, 8, &arena);
 
     // create player objects
+    if (nPlayers > maxPlayers) {
+        throw std::invalid_argument("Too many players.");
+    }
     if (abilities.size() != nPlayers || linkPlacements.size() != nPlayers) {
         throw std::invalid_argument(
             "Incorrect number of abilities/link placements.");
     }
 
     players.clear();
+    players.reserve(nPlayers);
 
     for (unsigned i = 0; i < nPlayers; ++i) {
-        std::vector<std::unique_ptr<Ability>> p_abilities;
-        std::map<char, int> freq;
+        std::pmr::vector<ArenaPtr<Ability>> p_abilities{&arena};
+        p_abilities.reserve(abilities[i].size());
+        unsigned freq[256] = {};
         for (auto ch : abilities[i]) {
-            p_abilities.push_back(AbilityFactory::createPlayerAbility(ch));
-            if (++freq[ch] > 2) {
+            p_abilities.push_back(
+                AbilityFactory::createPlayerAbility(ch, &arena));
+            if (++freq[static_cast<unsigned char>(ch)] > 2) {
                 throw std::invalid_argument(
                     "Incorrect number of abilities/link placements.");
             }
         }
-        players.push_back(
-            std::make_unique<Player>(std::move(p_abilities), linkManager, this));
+        players.push_back(makeArena<Player>(&arena, std::move(p_abilities),
+                                            linkManager.get(), this));
         linkManager->addLinksForPlayer(linkPlacements[i], players[i].get(),
                                        board.get());
     }
@@ -51,44 +61,112 @@ void Game::startGame(
     // for now, assume the board is 10 rows x 8 cols
     // and that the 1st and last rows are goal rows.
     // first 2 placements are server ports.
-    std::vector<std::pair<int, int>> p1placements = {
+    static const std::vector<std::pair<int, int>> p1placements = {
         {8, 3}, {8, 4}, {1, 0}, {8, 1}, {8, 2},
         {7, 3}, {7, 4}, {8, 5}, {8, 6}, {8, 7}};
 
-    std::vector<std::pair<int, int>> p2placements = {
+    static const std::vector<std::pair<int, int>> p2placements = {
         {1, 3}, {1, 4}, {8, 0}, {1, 1}, {1, 2},
         {2, 3}, {2, 4}, {1, 5}, {1, 6}, {1, 7}};
 
     board->placePlayerCells(p1placements, players[0].get(), 9, this);  // p1
     board->placePlayerCells(p2placements, players[1].get(), 0, this);  // p2
 
+    // every player starts out knowing only their own links
+    knowledge.assign(nPlayers, 0);
+    for (unsigned i = 0; i < nPlayers; ++i) {
+        knowledge[i] = 0xFFu << (i * 8);
+    }
+
+    identities.assign(nPlayers * 8, {Link::LinkType::VIRUS, 0});
+    for (unsigned i = 0; i < nPlayers; ++i) {
+        for (unsigned j = 0; j < 8; ++j) {
+            LinkKey key{players[i].get(), j};
+            if (!linkManager->hasLink(key)) continue;
+            const Link& link = linkManager->getLink(key);
+            identities[i * 8 + j] = {link.getType(), link.getStrength()};
+        }
+    }
+
+    loadouts.assign(abilities.begin(), abilities.end());
     currentPlayerIndex = 0;
+    turn = 0;
+    recount();
     // printGameInfo();
 }
 
+void Game::reset(unsigned nPlayers, const std::vector<std::string>& abilities,
+                 const std::vector<std::vector<std::string>>& linkPlacements) {
+    clear();
+    startGame(nPlayers, abilities, linkPlacements);
+}
+
+void Game::clear() {
+    // everything in the arena must be gone before it is rewound; the
+    // vectors are swapped out so their buffers go too
+    linkManager.reset();
+    board.reset();
+    std::pmr::vector<ArenaPtr<Player>>{&arena}.swap(players);
+    std::pmr::vector<unsigned>{&arena}.swap(knowledge);
+    std::pmr::vector<std::pair<Link::LinkType, int>>{&arena}.swap(identities);
+    std::pmr::vector<std::pmr::string>{&arena}.swap(loadouts);
+    std::pmr::vector<uint8_t>{&arena}.swap(linksLeft);
+    arena.release();
+
+    // popping keeps the queue's last block for the next game
+    while (!queue.empty()) queue.pop();
+    winner = nullptr;
+}
+
 Player* Game::getCurrentPlayer() { return players[currentPlayerIndex].get(); }
 
-Player* Game::checkWinLoss() {
-    // count players
-    int activePlayerCount = 0;
-    Player* p = nullptr;
-    for (const auto& it : players) {
-        if (it != nullptr) {
-            activePlayerCount++;
-            p = it.get();
-            // downloaded 4 links
-            // implicit assertion: only 1 player can reach 4 links before this
-            // is called (does not handle winning ties)
-            if (p->getScore().first >= 4) {
-                return p;
-            }
+unsigned Game::getCurrentPlayerIndex() const { return currentPlayerIndex; }
+
+Player* Game::checkWinLoss() const { return winner; }
+
+void Game::decideWinner() {
+    // the first player to have downloaded enough data wins, or else the
+    // last one standing
+    Player* last = nullptr;
+    for (const auto& p : players) {
+        if (p == nullptr) continue;
+        if (p->getScore().first >= winningData) {
+            winner = p.get();
+            return;
         }
+        last = p.get();
     }
+    winner = alivePlayers == 1 ? last : nullptr;
+}
 
-    if (activePlayerCount == 1) {
-        return p;
+void Game::recount() {
+    linksLeft.assign(players.size(), 0);
+    alivePlayers = 0;
+    losing = 0;
+    for (unsigned i = 0; i < players.size(); ++i) {
+        if (players[i] == nullptr) continue;
+        ++alivePlayers;
+        for (unsigned j = 0; j < 8; ++j) {
+            linksLeft[i] += linkManager->hasLink({players[i].get(), j});
+        }
+        if (linksLeft[i] == 0 ||
+            players[i]->getScore().second >= losingViruses) {
+            losing |= 1u << i;
+        }
     }
-    return nullptr;
+    decideWinner();
+}
+
+void Game::scoreChanged(const Player& player) {
+    auto [data, viruses] = player.getScore();
+    if (viruses >= losingViruses) losing |= 1u << getPlayerIndex(player);
+    if (data >= winningData) decideWinner();
+}
+
+void Game::linkRemoved(LinkKey key, std::pair<int, int> coords) {
+    board->linkRemoved(key.player, coords);
+    unsigned i = getPlayerIndex(*key.player);
+    if (--linksLeft[i] == 0) losing |= 1u << i;
 }
 
 unsigned Game::getPlayerIndex(const Player& player) const {
@@ -98,66 +176,145 @@ unsigned Game::getPlayerIndex(const Player& player) const {
     return -1;
 }
 
+std::pmr::memory_resource* Game::getArena() { return &arena; }
+
+std::size_t Game::getArenaOverflow() const { return arenaOverflow.getHeld(); }
+
 LinkManager& Game::getLinkManager() const { return *linkManager; }
 
+unsigned Game::getTurn() const { return turn; }
+
 void Game::nextTurn() {
+    AllocStats::Scope scope{AllocTag::Game};
+    ++turn;
+    AllocStats::endTurn();
     cleanPlayers();
     do {
         currentPlayerIndex = (currentPlayerIndex + 1) % players.size();
     } while (players[currentPlayerIndex] == nullptr);
-    std::cout << "Turn of Player " << currentPlayerIndex + 1 << "\n";
-}
-
-void Game::makeMove(unsigned link, char dir) {
-    try {
-        LinkKey linkKey = LinkKey{players[currentPlayerIndex].get(), link};
-        linkManager->getLink(linkKey).requestMove(Link::charToDirection(dir),
-                                                  this);
-        nextTurn();
-    } catch (std::exception& e) {
-        std::cout << "Invalid command: " << e.what() << std::endl;
-        // comment this out for final build
-        // throw e;
-    }
+    Log::info("Turn of Player ", currentPlayerIndex + 1);
 }
 
-void Game::addUpdate(update_type update) { queue.push(update); }
+void Game::makeMove(unsigned link, Link::Direction dir) {
+    static Timers::Site site{"Game::makeMove"};
+    Timers::Scope timer{site};
+    Trace::Span span{"makeMove", "engine"};
+    AllocStats::Scope scope{AllocTag::Game};
+    LinkKey linkKey = LinkKey{players[currentPlayerIndex].get(), link};
+    linkManager->getLink(linkKey).requestMove(dir, this);
+    nextTurn();
+}
+
+void Game::addUpdate(update_type update) {
+    AllocStats::Scope scope{AllocTag::Updates};
+    queue.push(update);
+}
 
 std::queue<Game::update_type> Game::flushUpdates() {
+    AllocStats::Scope scope{AllocTag::Updates};
     std::queue<update_type> temp = std::move(queue);
     queue = {};
     return temp;
 }
 
-void Game::useAbility(int id, const std::vector<std::string>& params) {
-    std::cout << "I'm using an ability RAAAHHHHHHH" << "\n";
+void Game::revealLink(LinkKey key, const Player& observer) {
+    unsigned observerId = getPlayerIndex(observer);
+    unsigned bit = 1u << (getPlayerIndex(*key.player) * 8 + key.id);
+    if (knowledge[observerId] & bit) return;
+    knowledge[observerId] |= bit;
+    addUpdate(getRevealUpdate(key));
+}
+
+void Game::revealLinkToAll(LinkKey key) {
+    unsigned bit = 1u << (getPlayerIndex(*key.player) * 8 + key.id);
+    bool changed = false;
+    for (auto& mask : knowledge) {
+        changed = changed || !(mask & bit);
+        mask |= bit;
+    }
+    if (changed) addUpdate(getRevealUpdate(key));
+}
+
+bool Game::isRevealedTo(unsigned observer, unsigned playerId,
+                        unsigned linkId) const {
+    return knowledge[observer] & (1u << (playerId * 8 + linkId));
+}
+
+unsigned Game::getRevealMask(unsigned observer) const {
+    return knowledge[observer];
+}
+
+View::RevealLinkUpdate Game::getRevealUpdate(LinkKey key) {
+    AllocStats::Scope scope{AllocTag::Updates};
+    const Link& link = linkManager->getLink(key);
+    identities[getPlayerIndex(*key.player) * 8 + key.id] = {
+        link.getType(), link.getStrength()};
+    std::string value = (link.getType() == Link::LinkType::DATA ? "D" : "V") +
+                        std::to_string(link.getStrength());
+    return {getPlayerIndex(*key.player), key.id, value};
+}
+
+void Game::useAbility(int id, const AbilityArgs& args) {
+    AllocStats::Scope scope{AllocTag::Game};
+    auto& abilities = players[currentPlayerIndex]->getAbilities();
+    if (id < 1 || id > (int)abilities.size()) {
+        throw std::invalid_argument("No ability with that id");
+    }
+    Trace::Span span{abilities[id - 1]->getName(), "ability"};
+    abilities[id - 1]->use(*this, args);
 }
 
 std::vector<Player*> Game::getPlayers() const {
     std::vector<Player*> result(players.size());
     std::transform(players.begin(), players.end(), result.begin(),
-                   [](const std::unique_ptr<Player>& p) { return p.get(); });
+                   [](const ArenaPtr<Player>& p) { return p.get(); });
     return result;
 }
 
 void Game::cleanPlayers() {
-    for (auto& pl : players) {
-        if (pl != nullptr) {
-            // loss condition 1: player has 4 viruses
-            bool has4virus = pl->getScore().second >= 4;
+    if (!losing) return;
+    Trace::Span span{"cleanPlayers", "engine"};
+    auto eliminate = [this](unsigned i) {
+        Log::info("Player ", i + 1, " is eliminated");
+        Player* pl = players[i].get();
+        // clear board
+        board->removePlayerCells(pl, this);
+        // clean link manager
+        linkManager->cleanPlayer(pl);
+        // set to nullptr
+        players[i] = nullptr;
+        losing &= ~(1u << i);
+        --alivePlayers;
+        decideWinner();
+    };
+
+    unsigned noLinks = 0;  // bit i is set if player i has no links
+    unsigned survivors = alivePlayers;
+    for (unsigned i = 0; i < players.size(); ++i) {
+        if (!(losing & (1u << i))) continue;
+        int viruses = players[i]->getScore().second;
+        Log::debug("Player ", i + 1, ": ", viruses, " viruses, ",
+                   unsigned{linksLeft[i]}, " links left");
+        --survivors;
+        // loss condition 1: player has downloaded too many viruses
+        if (viruses >= losingViruses) {
+            eliminate(i);
+        } else {
             // loss condition 2: player has no links
-            bool noLinks = linkManager->playerIsEmpty(pl.get());
-            std::cout << has4virus << " " << "bongo2\n";
-            if (has4virus || noLinks) {
-                // clear board
-                board->removePlayerCells(pl.get());
-                // clean link manager
-                linkManager->cleanPlayer(pl.get());
-                // set to nullptr
-                pl = nullptr;
-            }
+            noLinks |= 1u << i;
         }
     }
+    // a battle can cost one player their last link while handing the other
+    // their fourth virus; the virus loss decides it, so the player left
+    // without links stays in as the last one standing
+    for (unsigned i = 0; i < players.size(); ++i) {
+        if (players[i] == nullptr || !(noLinks & (1u << i))) continue;
+        if (survivors == 0) {
+            ++survivors;
+            continue;
+        }
+        eliminate(i);
+    }
 }
 
 Board& Game::getBoard() const { return *board; }
@@ -165,28 +322,31 @@ Board& Game::getBoard() const { return *board; }
 const std::pair<Link::LinkType, int> Game::getPlayerLink(
     const int playerId, const unsigned linkId) const {
     LinkKey linkKey = LinkKey{players[playerId].get(), linkId};
+    if (!players[playerId] || !linkManager->hasLink(linkKey)) {
+        return identities[playerId * 8 + linkId];
+    }
     const Link& link = linkManager->getLink(linkKey);
     return {link.getType(), link.getStrength()};
 }
 
 void Game::printGameInfo() {
     // print board info, cell info, link info, player info.
-    std::cout << "Player info:\n";
+    *out << "Player info:\n";
     for (unsigned i = 0; i < players.size(); ++i) {
-        std::cout << "Info for player " << i + 1 << "\n";
+        *out << "Info for player " << i + 1 << "\n";
         if (players[i].get() == nullptr) {
-            std::cout << "This player is COOKED\n";
+            *out << "This player is COOKED\n";
             continue;
         }
         auto [data, viruses] = players[i]->getScore();
-        std::cout << "Data: " << data << " Viruses: " << viruses << "\n";
+        *out << "Data: " << data << " Viruses: " << viruses << "\n";
 
-        std::cout << "Links:\n";
+        *out << "Links:\n";
         for (unsigned j = 0; j < 8; ++j) {
             LinkManager::LinkKey k{players[i].get(), j};
-            std::cout << "Link " << j << " ";
+            *out << "Link " << j << " ";
             if (!linkManager->hasLink(k)) {
-                std::cout << "is COOKED\n";
+                *out << "is COOKED\n";
                 continue;
             }
             int strength = linkManager->getLink(k).getStrength();
@@ -195,24 +355,26 @@ void Game::printGameInfo() {
                 linkManager->getLink(k).getType() == Link::LinkType::VIRUS
                     ? 'V'
                     : 'D';
-            std::cout << " strength " << strength << " type " << type << " ";
+            *out << " strength " << strength << " type " << type << " ";
             auto [linkr, linkc] = linkManager->getLink(k).getCoords();
-            std::cout << "location (" << linkr << ", " << linkc << ")\n";
+            *out << "location (" << linkr << ", " << linkc << ")\n";
         }
-        std::cout << "\n";
+        *out << "\n";
     }
 
-    std::cout << "Board state:\n";
+    *out << "Board state:\n";
     auto& b = board->getBoard();
     for (unsigned r = 1; r < b.size() - 1; ++r) {
         std::string s = "";
         for (unsigned c = 0; c < b[0].size(); ++c) {
             s += b[r][c]->cellRepresentation(this);
         }
-        std::cout << s << "\n";
+        *out << s << "\n";
     }
 }
 
-Game::Game() {}
+Game::Game() : out{&std::cout} {}
 
 Game::~Game() {}
+
+void Game::setOutput(std::ostream& stream) { out = &stream; }
@@ -0,0 +1,35 @@
+#include "gamepool.h"
+
+#include "game.h"
+
+void GamePool::Return::operator()(Game* game) const {
+    GamePool::local().release(game);
+}
+
+GamePool::GamePool(std::size_t capacity) : capacity{capacity} {
+    idle.reserve(capacity);
+}
+
+GamePool::~GamePool() {}
+
+GamePool& GamePool::local() {
+    thread_local GamePool pool;
+    return pool;
+}
+
+GamePool::Handle GamePool::acquire() {
+    if (idle.empty()) return Handle{new Game};
+    Handle game{idle.back().release()};
+    idle.pop_back();
+    return game;
+}
+
+void GamePool::release(Game* game) {
+    if (idle.size() == capacity) {
+        delete game;
+        return;
+    }
+    idle.emplace_back(game);
+}
+
+std::size_t GamePool::size() const { return idle.size(); }
@@ -0,0 +1,455 @@
+#include "gamestate.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "ability.h"
+#include "board.h"
+#include "cell.h"
+#include "factories.h"
+#include "game.h"
+#include "link.h"
+#include "linkmanager.h"
+#include "player.h"
+
+namespace {
+
+constexpr char saveMagic[4] = {'R', 'N', 'S', 'V'};
+constexpr uint8_t saveVersion = 1;
+
+// precedes the raw GameState in a save file
+struct SaveHeader {
+    char magic[4];
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t stateSize; /**< sizeof(GameState) in the build that saved. */
+};
+
+// the chain of a link from the outermost decorator down to the base link,
+// in a fixed array so that capturing a game allocates nothing
+struct LinkChain {
+    static constexpr unsigned capacity = GameState::maxLinkLayers + 1;
+    const Link *links[capacity];
+    unsigned length = 0;
+
+    explicit LinkChain(const Link *link) {
+        links[length++] = link;
+        while (auto decorator = dynamic_cast<const LinkDecorator *>(link)) {
+            link = decorator->getBase();
+            if (length == capacity) {
+                throw std::length_error("Too many decorators to save");
+            }
+            links[length++] = link;
+        }
+    }
+
+    unsigned size() const { return length; }
+    const Link *operator[](unsigned i) const { return links[i]; }
+    const Link *back() const { return links[length - 1]; }
+};
+
+uint8_t linkLayer(const Link *link) {
+    if (dynamic_cast<const LinkBoostDecorator *>(link)) return GameState::Boost;
+    if (dynamic_cast<const PolarizeDecorator *>(link)) {
+        return GameState::Polarize;
+    }
+    if (dynamic_cast<const QuantumEntanglementDecorator *>(link)) {
+        return GameState::Entangle;
+    }
+    throw std::invalid_argument("Cannot save this kind of link decorator");
+}
+
+uint8_t cellLayer(const PlayerCell *cell) {
+    if (dynamic_cast<const Server *>(cell)) return GameState::Server;
+    if (dynamic_cast<const Firewall *>(cell)) return GameState::Firewall;
+    if (dynamic_cast<const Goal *>(cell)) return GameState::Goal;
+    throw std::invalid_argument("Cannot save this kind of cell");
+}
+
+}  // namespace
+
+GameState GameState::capture(const Game &game) {
+    GameState state;
+    capture(game, state);
+    return state;
+}
+
+void GameState::capture(const Game &game, GameState &state) {
+    if (game.players.size() > maxPlayers) {
+        throw std::length_error("Too many players to save");
+    }
+    state = {};
+    state.turn = game.turn;
+    state.playerCount = game.players.size();
+    state.currentPlayer = game.currentPlayerIndex;
+    for (unsigned i = 0; i < game.knowledge.size(); ++i) {
+        state.knowledge[i] = game.knowledge[i];
+    }
+
+    auto indexOf = [&](const Player *player) -> uint8_t {
+        for (unsigned i = 0; i < game.players.size(); ++i) {
+            if (player && game.players[i].get() == player) return i;
+        }
+        return none;
+    };
+
+    // where every layer of every link lives, so entangled partners can be
+    // stored as references instead of pointers; looked up only for
+    // entangled links, so a linear search does
+    struct Layer {
+        const Link *link;
+        LinkRef ref;
+    };
+    Layer refs[maxPlayers * linksPerPlayer * LinkChain::capacity];
+    unsigned refCount = 0;
+    for (unsigned i = 0; i < game.players.size(); ++i) {
+        if (!game.players[i]) continue;
+        auto found = game.linkManager->linkMap.find(game.players[i].get());
+        if (found == game.linkManager->linkMap.end()) continue;
+        const auto &links = found->second;
+        for (unsigned j = 0; j < links.size() && j < linksPerPlayer; ++j) {
+            if (!links[j]) continue;
+            LinkChain chain{links[j].get()};
+            for (unsigned k = 0; k < chain.size(); ++k) {
+                refs[refCount++] = {chain[k],
+                                    {uint8_t(i), uint8_t(j),
+                                     uint8_t(chain.size() - 1 - k)}};
+            }
+        }
+    }
+    auto refOf = [&](const Link *link) -> const LinkRef * {
+        for (unsigned r = 0; r < refCount; ++r) {
+            if (refs[r].link == link) return &refs[r].ref;
+        }
+        return nullptr;
+    };
+
+    for (unsigned i = 0; i < game.players.size(); ++i) {
+        PlayerState &ps = state.players[i];
+        // links that have left the board keep their published identity
+        for (unsigned j = 0; j < linksPerPlayer; ++j) {
+            auto [type, strength] = game.identities[i * 8 + j];
+            ps.links[j].isData = type == Link::LinkType::DATA;
+            ps.links[j].strength = strength;
+        }
+        const Player *player = game.players[i].get();
+        if (!player) continue;
+        ps.alive = true;
+        ps.data = player->score.first;
+        ps.viruses = player->score.second;
+        ps.abilitiesUsed = player->abilitiesUsed;
+        const auto &loadout = game.loadouts[i];
+        if (loadout.size() > maxAbilities) {
+            throw std::length_error("Too many abilities to save");
+        }
+        ps.abilityCount = loadout.size();
+        for (unsigned a = 0; a < loadout.size(); ++a) {
+            ps.abilities[a] = loadout[a];
+            if (player->abilities[a]->isUsed()) ps.usedMask |= 1u << a;
+        }
+
+        auto found = game.linkManager->linkMap.find(game.players[i].get());
+        if (found == game.linkManager->linkMap.end()) continue;
+        const auto &links = found->second;
+        for (unsigned j = 0; j < links.size() && j < linksPerPlayer; ++j) {
+            if (!links[j]) continue;
+            LinkState &ls = ps.links[j];
+            LinkChain chain{links[j].get()};
+            const Link *base = chain.back();
+            ls.present = true;
+            ls.isData = base->getType() == Link::LinkType::DATA;
+            ls.strength = base->getStrength();
+            ls.row = base->getCoords().first;
+            ls.col = base->getCoords().second;
+            ls.layerCount = chain.size() - 1;
+            for (unsigned k = 0; k + 1 < chain.size(); ++k) {
+                ls.layers[k] = linkLayer(chain[k]);
+                ls.partners[k] = {none, 0, 0};
+                auto qe =
+                    dynamic_cast<const QuantumEntanglementDecorator *>(chain[k]);
+                if (!qe) continue;
+                // a partner that has been downloaded is no longer anywhere
+                if (auto partner = refOf(qe->getPartner())) {
+                    ls.partners[k] = *partner;
+                }
+            }
+        }
+    }
+
+    auto &board = game.board->getBoard();
+    for (unsigned r = 0; r < rows; ++r) {
+        for (unsigned c = 0; c < cols; ++c) {
+            CellState &cs = state.cells[r][c];
+            const BaseCell *cell = board[r][c].get();
+            while (auto layer = dynamic_cast<const PlayerCell *>(cell)) {
+                if (cs.layerCount == maxCellLayers) {
+                    throw std::length_error("Too many cell layers to save");
+                }
+                cs.layers[cs.layerCount] = cellLayer(layer);
+                cs.owners[cs.layerCount] = indexOf(layer->owner);
+                ++cs.layerCount;
+                cell = layer->base.get();
+            }
+            cs.occupantPlayer = none;
+            if (cell->isOccupied()) {
+                auto key = cell->getOccupantLink();
+                cs.occupantPlayer = indexOf(key.player);
+                cs.occupantId = key.id;
+            }
+        }
+    }
+}
+
+void GameState::restore(Game &game) const {
+    if (playerCount != game.players.size() || playerCount > maxPlayers ||
+        currentPlayer >= playerCount) {
+        throw std::invalid_argument("Saved game has a different player count");
+    }
+    if (game.board->getBoard().size() != rows ||
+        game.board->getBoard()[0].size() != cols) {
+        throw std::invalid_argument("Saved game has a different board size");
+    }
+    // the game is torn down below, so a bad layer must be found first
+    for (unsigned i = 0; i < playerCount; ++i) {
+        for (const LinkState &ls : players[i].links) {
+            if (!ls.present) continue;
+            if (ls.layerCount > maxLinkLayers) {
+                throw std::invalid_argument("Unknown link decorator");
+            }
+            for (unsigned k = 0; k < ls.layerCount; ++k) {
+                if (ls.layers[k] != Boost && ls.layers[k] != Polarize &&
+                    ls.layers[k] != Entangle) {
+                    throw std::invalid_argument("Unknown link decorator");
+                }
+            }
+        }
+    }
+    for (const auto &row : cells) {
+        for (const CellState &cs : row) {
+            if (cs.layerCount > maxCellLayers) {
+                throw std::invalid_argument("Unknown cell layer");
+            }
+            for (unsigned k = 0; k < cs.layerCount; ++k) {
+                if (cs.layers[k] < Server || cs.layers[k] > Goal) {
+                    throw std::invalid_argument("Unknown cell layer");
+                }
+            }
+        }
+    }
+
+    // the whole game is rebuilt in a rewound arena, so restoring again and
+    // again does not grow it
+    game.clear();
+    std::pmr::memory_resource *arena = &game.arena;
+    game.linkManager = makeArena<LinkManager>(arena, arena);
+    game.board = makeArena<::Board>(arena, rows, cols, arena);
+    game.players.resize(playerCount);
+
+    game.turn = turn;
+    game.currentPlayerIndex = currentPlayer;
+    game.knowledge.assign(knowledge, knowledge + playerCount);
+    game.loadouts.resize(playerCount);
+
+    // players
+    LinkManager &lm = *game.linkManager;
+    for (unsigned i = 0; i < playerCount; ++i) {
+        const PlayerState &ps = players[i];
+        if (!ps.alive) {
+            game.players[i] = nullptr;
+            continue;
+        }
+        std::pmr::vector<ArenaPtr<Ability>> abilities{arena};
+        for (unsigned a = 0; a < ps.abilityCount && a < maxAbilities; ++a) {
+            abilities.push_back(
+                AbilityFactory::createPlayerAbility(ps.abilities[a], arena));
+            if (ps.usedMask & (1u << a)) abilities.back()->markUsed();
+        }
+        game.loadouts[i].assign(ps.abilities, ps.abilityCount);
+        game.players[i] =
+            makeArena<Player>(arena, std::move(abilities), &lm, &game);
+        Player &player = *game.players[i];
+        player.score = {ps.data, ps.viruses};
+        player.abilitiesUsed = ps.abilitiesUsed;
+    }
+
+    // links, innermost layer first; entangled partners are patched in once
+    // every chain exists
+    Board *board = game.board.get();
+    std::vector<std::pair<QuantumEntanglementDecorator *, LinkRef>> entangled;
+    for (unsigned i = 0; i < playerCount; ++i) {
+        Player *player = game.players[i].get();
+        if (!player) continue;
+        auto &links = lm.linkMap[player];
+        links.resize(linksPerPlayer);
+        for (unsigned j = 0; j < linksPerPlayer; ++j) {
+            const LinkState &ls = players[i].links[j];
+            if (!ls.present) continue;
+            std::pair<int, int> coords{ls.row, ls.col};
+            ArenaPtr<Link> link;
+            if (ls.isData) {
+                link = makeArena<DataLink>(arena, coords, ls.strength, player,
+                                           board);
+            } else {
+                link = makeArena<VirusLink>(arena, coords, ls.strength, player,
+                                            board);
+            }
+            for (int k = int(ls.layerCount) - 1; k >= 0; --k) {
+                switch (ls.layers[k]) {
+                    case Boost:
+                        link = makeArena<LinkBoostDecorator>(
+                            arena, std::move(link));
+                        break;
+                    case Polarize:
+                        link = makeArena<PolarizeDecorator>(
+                            arena, std::move(link));
+                        break;
+                    case Entangle: {
+                        auto qe = makeArena<QuantumEntanglementDecorator>(
+                            arena, std::move(link), nullptr);
+                        entangled.push_back({qe.get(), ls.partners[k]});
+                        link = std::move(qe);
+                        break;
+                    }
+                    default:
+                        throw std::invalid_argument("Unknown link decorator");
+                }
+            }
+            links[j] = std::move(link);
+        }
+    }
+    game.identities.assign(playerCount * 8, {Link::LinkType::VIRUS, 0});
+    for (unsigned i = 0; i < playerCount; ++i) {
+        for (unsigned j = 0; j < linksPerPlayer; ++j) {
+            const LinkState &ls = players[i].links[j];
+            game.identities[i * 8 + j] = {
+                ls.isData ? Link::LinkType::DATA : Link::LinkType::VIRUS,
+                ls.strength};
+            if (!ls.present) continue;
+            const Link &link = *lm.linkMap[game.players[i].get()][j];
+            game.identities[i * 8 + j] = {link.getType(), link.getStrength()};
+        }
+    }
+
+    for (auto &[qe, ref] : entangled) {
+        if (ref.player >= playerCount || !game.players[ref.player]) continue;
+        auto &links = lm.linkMap[game.players[ref.player].get()];
+        if (ref.id >= links.size() || !links[ref.id]) continue;
+        LinkChain chain{links[ref.id].get()};
+        if (ref.depth >= chain.size()) continue;
+        qe->setPartner(
+            const_cast<Link *>(chain[chain.size() - 1 - ref.depth]));
+    }
+
+    // cells, innermost layer first
+    auto ownerAt = [&](uint8_t index) -> Player * {
+        return index < playerCount ? game.players[index].get() : nullptr;
+    };
+    auto &cells = game.board->getBoard();
+    for (unsigned r = 0; r < rows; ++r) {
+        for (unsigned c = 0; c < cols; ++c) {
+            const CellState &cs = this->cells[r][c];
+            ArenaPtr<BaseCell> cell = makeArena<BoardCell>(arena);
+            if (Player *occupant = ownerAt(cs.occupantPlayer)) {
+                cell->setOccupantLink({occupant, cs.occupantId});
+            }
+            for (int k = int(cs.layerCount) - 1; k >= 0; --k) {
+                Player *owner = ownerAt(cs.owners[k]);
+                switch (cs.layers[k]) {
+                    case Server:
+                        cell = makeArena<::Server>(arena, std::move(cell),
+                                                   owner);
+                        break;
+                    case Firewall:
+                        cell = makeArena<::Firewall>(arena, std::move(cell),
+                                                     owner);
+                        break;
+                    case Goal:
+                        cell = makeArena<::Goal>(arena, std::move(cell),
+                                                 owner);
+                        break;
+                    default:
+                        throw std::invalid_argument("Unknown cell layer");
+                }
+            }
+            cells[r][c] = std::move(cell);
+        }
+    }
+
+    // the board's index and the counts that decide wins and losses follow
+    // the restored state
+    game.board->reindex();
+    game.recount();
+}
+
+void GameState::save(const std::string &path) const {
+    SaveHeader header{};
+    std::memcpy(header.magic, saveMagic, sizeof(saveMagic));
+    header.version = saveVersion;
+    header.stateSize = sizeof(GameState);
+
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out{temp, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(this), sizeof(*this));
+        if (!out.flush()) {
+            std::remove(temp.c_str());
+            throw std::invalid_argument("Cannot write save file " + path);
+        }
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        throw std::invalid_argument("Cannot write save file " + path);
+    }
+}
+
+GameState GameState::load(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::invalid_argument("File " + path + " not found");
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || size_t(info.st_size) < sizeof(SaveHeader)) {
+        close(fd);
+        throw std::invalid_argument(path + " is not a save file");
+    }
+    size_t size = info.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::invalid_argument("Cannot map " + path);
+    }
+
+    SaveHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    GameState state{};
+    bool complete = size == sizeof(header) + sizeof(state);
+    if (complete) {
+        std::memcpy(&state, static_cast<const char *>(data) + sizeof(header),
+                    sizeof(state));
+    }
+    munmap(data, size);
+
+    if (std::memcmp(header.magic, saveMagic, sizeof(saveMagic)) != 0) {
+        throw std::invalid_argument(path + " is not a save file");
+    }
+    if (header.version != saveVersion ||
+        header.stateSize != sizeof(GameState)) {
+        throw std::invalid_argument(path + " was saved by another version");
+    }
+    if (!complete || state.playerCount == 0 ||
+        state.playerCount > maxPlayers ||
+        state.currentPlayer >= state.playerCount) {
+        throw std::invalid_argument(path + " is corrupt");
+    }
+    return state;
+}
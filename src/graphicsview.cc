@@ -1,179 +1,309 @@
 #include "views.h"
 
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <string>
 
 #include "board.h"
 #include "cell.h"
 #include "game.h"
-#include "window.h"
+#include "link.h"
+#include "player.h"
+#include "timers.h"
+#include "trace.h"
 
-GraphicsView::GraphicsView(Game *game)
-    : View(game, nullptr), Xwindow(1000, 700), height(8), width(8), game{game}, cPlayer{0} {
+GraphicsView::GraphicsView(Game *game, std::unique_ptr<RenderBackend> backend)
+    : View(game, nullptr), backend{std::move(backend)}, height(8), width(8), game{game} {
     lm = &game->getLinkManager();
     nPlayers = game->getPlayers().size();
-    players = std::vector<PlayerInfo>(nPlayers);
     b = &game->getBoard();
-    boardStates = std::vector<std::vector<char>>(8, std::vector<char>(8, ' '));
-    boardStates[0][3] = 'S';
-    boardStates[0][4] = 'S';
-    boardStates[7][3] = 'S';
-    boardStates[7][4] = 'S';
-    std::vector<int> cols = {lPurple, lGreen};
+
+    readGame();
+
+    // Leave some margin around the grid
+    int margin = 50;
+    int maxGridWidth = this->backend->getWidth() - 2 * margin;
+    int maxGridHeight = this->backend->getHeight() - 2 * margin;
+    // Square cells at 2/3 of the largest size that fits
+    cellSize = std::min(maxGridWidth / (int)width, maxGridHeight / (int)height) * 2 / 3;
+    // Position grid at the left edge with margin
+    gridX = margin;
+    gridY = (this->backend->getHeight() - cellSize * (int)height) / 2;
+
+    pending.fullRedraw = true;
+    pending.dirtyCells = std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
+    pending.dirtyPanels = std::vector<bool>(nPlayers, false);
+
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (this->backend->isInteractive()) {
+        // from here on only the render thread talks to the backend
+        renderThread = std::thread(&GraphicsView::renderLoop, this);
+    }
+    refresh();
+}
+
+void GraphicsView::readGame() {
+    pending.cPlayer = game->getPlayerIndex(*game->getCurrentPlayer());
+    pending.players = std::vector<PlayerInfo>(nPlayers);
+    pending.boardStates = std::vector<std::vector<char>>(8, std::vector<char>(8, ' '));
+    for (unsigned r=0; r<height; ++r) {
+        for (unsigned c=0; c<width; ++c) {
+            pending.boardStates[r][c] = b->getBoard()[r+1][c]->cellRepresentation(game)[0];
+        }
+    }
+    pending.occupants = std::vector<std::vector<int>>(8, std::vector<int>(8, -1));
+    std::vector<int> cols = {RenderBackend::lPurple, RenderBackend::lGreen};
     for (int i=0; i<nPlayers; ++i) {
-        players[i].player = game->getPlayers()[i];
-        players[i].colour = cols[i];
-        players[i].score = {0, 0};
-        players[i].abilitiesLeft = 5;
-        players[i].revealedLinks = 0;
-        players[i].isAlive = true;
+        PlayerInfo &player = pending.players[i];
+        Player *owner = game->getPlayers()[i];
+        player.colour = cols[i];
+        player.isAlive = owner != nullptr;
+        player.score = owner ? owner->getScore() : std::pair<int, int>{0, 0};
+        player.abilitiesLeft =
+            owner ? owner->getAbilities().size() - owner->getAbilitiesUsed() : 0;
+        player.revealedLinks = game->getRevealMask(i);
+        // read the positions from the model here only; afterwards the slots only change
+        // in response to updates
+        for (unsigned j=0; j<8; ++j) {
+            auto [type, strength] = game->getPlayerLink(i, j);
+            player.links[j].type = type == Link::LinkType::DATA ? 'D' : 'V';
+            player.links[j].strength = strength;
+            LinkManager::LinkKey k = {owner, j};
+            if (!owner || !lm->hasLink(k)) continue;
+            auto [r, c] = lm->getLink(k).getCoords();
+            player.links[j].onBoard = true;
+            player.links[j].r = r;
+            player.links[j].c = c;
+            if (r >= 1 && r <= 8) pending.occupants[r-1][c] = i * 8 + j;
+        }
+    }
+}
+
+void GraphicsView::reload() {
+    {
+        std::lock_guard<std::mutex> lock{stateMutex};
+        // restoring rebuilds the board and links
+        lm = &game->getLinkManager();
+        b = &game->getBoard();
+        readGame();
+        pending.fullRedraw = true;
     }
     refresh();
 }
 
+GraphicsView::~GraphicsView() {
+    if (!renderThread.joinable()) {
+        close(wakeFd);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{stateMutex};
+        stopping = true;
+    }
+    uint64_t one = 1;
+    write(wakeFd, &one, sizeof(one));
+    renderThread.join();
+    close(wakeFd);
+}
+
+GraphicsView::Rect GraphicsView::cellRect(int r, int c) const {
+    return {gridX + c * cellSize, gridY + r * cellSize, cellSize, cellSize};
+}
+
+GraphicsView::Rect GraphicsView::panelRect(int playerIndex) const {
+    // 250x150 box plus its 2px border
+    int x = backend->getWidth() - 270;
+    int y = 80 + playerIndex * (150 + 20);
+    return {x - 1, y - 1, 250 + 3, 150 + 3};
+}
+
+void GraphicsView::markCell(int r, int c) {
+    if (r < 0 || r >= (int)height || c < 0 || c >= (int)width) return;
+    pending.dirtyCells[r][c] = true;
+}
+
+void GraphicsView::markPlayerLinks(int playerIndex) {
+    for (const auto& link : pending.players[playerIndex].links) {
+        if (link.onBoard) markCell(link.r - 1, link.c);
+    }
+}
+
+GraphicsView::linkDat &GraphicsView::slot(int occupant) {
+    return pending.players[occupant / 8].links[occupant % 8];
+}
+
 void GraphicsView::drawBoard() {
-    // Calculate grid dimensions and positioning
-    int windowWidth = getWidth();
-    int windowHeight = getHeight();
-    
-    // Leave some margin around the grid
-    int margin = 50;
-    
-    // Calculate the maximum grid size that fits in the window with margins
-    int maxGridWidth = windowWidth - 2 * margin;
-    int maxGridHeight = windowHeight - 2 * margin;
-    
-    // Calculate cell size to ensure square cells, but make it smaller
-    // Use the smaller dimension to ensure the grid fits, but scale it down
-    int cellSize = std::min(maxGridWidth / width, maxGridHeight / height) * 2 / 3;  // Make it 2/3 of the original size
-    
-    // Calculate actual grid dimensions
     int gridWidth = cellSize * width;
     int gridHeight = cellSize * height;
-    
-    // Position grid at the left edge with margin
-    int gridX = margin;
-    int gridY = (windowHeight - gridHeight) / 2;
-    
+
+    // Cells are drawn in layers; each layer is one batch
+    for (int layer = 0; layer < 3; ++layer) {
+        for (unsigned r = 0; r < height; ++r) {
+            for (unsigned c = 0; c < width; ++c) {
+                drawCell(r, c, layer);
+            }
+        }
+        if (layer < 2) backend->flushBatch();
+    }
+
     // Draw grid lines
     // Vertical lines
     for (unsigned col = 0; col <= width; ++col) {
         int x = gridX + col * cellSize;
-        drawLine(x, gridY, x, gridY + gridHeight, 2, Black);
+        backend->queueLine(x, gridY, x, gridY + gridHeight, 2, RenderBackend::Black);
     }
     
     // Horizontal lines
     for (unsigned row = 0; row <= height; ++row) {
         int y = gridY + row * cellSize;
-        drawLine(gridX, y, gridX + gridWidth, y, 2, Black);
+        backend->queueLine(gridX, y, gridX + gridWidth, y, 2, RenderBackend::Black);
     }
+    backend->flushBatch();
+}
 
-    // draw cells
-    std::string firewalls = "wm";
-    for (int r=0; r<8; ++r) {
-        for (int c=0; c<8; ++c) {
-            int col;
-            if (boardStates[r][c] == 'S') {
-                col = lBlue;
-            } else if (firewalls.find(boardStates[r][c]) != std::string::npos) {
-                col = dRed;
-            } else continue;
-
-            int x = gridX + c * cellSize + 5;
-            int y = gridY + r * cellSize + 5;
-            fillRectangle(x, y, cellSize-10, cellSize-10, col);
-        }
+void GraphicsView::drawCell(int r, int c, int layer) {
+    Rect cell = cellRect(r, c);
+
+    if (layer == 0) {
+        // Clear the inside of the cell, leaving the 2px grid lines untouched
+        backend->queueRectangle(cell.x + 2, cell.y + 2, cellSize - 3, cellSize - 3, RenderBackend::White);
+        return;
     }
 
-    
-    // Draw links on the grid
-    for (int playerIndex = 0; playerIndex < nPlayers; ++playerIndex) {
-        const PlayerInfo& player = players[playerIndex];
-        
-        for (size_t linkIndex = 0; linkIndex < player.linkRepresentations.size(); ++linkIndex) {
-            const auto& link = player.linkRepresentations[linkIndex];
-            
-            // Account for invisible rows: add 1 to row coordinate
-            // Rows increase downwards, so we need to flip the calculation
-            int adjustedRow = link.r - 1;
-            
-            // Calculate position on the grid
-            int x = gridX + link.c * cellSize + 5;
-            int y = gridY + adjustedRow * cellSize + 5;
-            
+    int x = cell.x + 5;
+    int y = cell.y + 5;
+
+    // Link occupying the cell, if any
+    int occupant = front.occupants[r][c];
+    if (occupant >= 0) {
+        int playerIndex = occupant / 8;
+        const PlayerInfo& player = front.players[playerIndex];
+        const linkDat& link = player.links[occupant % 8];
+
+        if (layer == 1) {
             // Draw the main player-colored square for the link
-            fillRectangle(x, y, cellSize-10, cellSize-10, player.colour);
-            
-            // Determine if link should be revealed
-            bool isRevealed = (playerIndex == cPlayer) || 
-                             (player.revealedLinks & (1 << linkIndex));
-            
-            // Draw the small indicator based on visibility and type
-            int smallBoxSize = cellSize / 3;
-            int smallBoxX = x + (cellSize - smallBoxSize) / 2;
-            int smallBoxY = y + (cellSize - smallBoxSize) / 2;
-            
-            if (!isRevealed) {
-                // Unrevealed link: draw smaller black box
-                fillRectangle(smallBoxX, smallBoxY, smallBoxSize, smallBoxSize, Black);
-            } else {
-                // Revealed link: draw colored box based on type
-                if (link.type == 'V') {
-                    // Virus: draw red box
-                    fillRectangle(smallBoxX, smallBoxY, smallBoxSize, smallBoxSize, dRed);
-                } else if (link.type == 'D') {
-                    // Data: draw green box
-                    fillRectangle(smallBoxX, smallBoxY, smallBoxSize, smallBoxSize, dGreen);
-                }
+            backend->queueRectangle(x, y, cellSize-10, cellSize-10, player.colour);
+            return;
+        }
+
+        // Determine if link should be revealed to the current player
+        bool isRevealed = front.players[front.cPlayer].revealedLinks & (1u << occupant);
+
+        // Draw the small indicator based on visibility and type
+        int smallBoxSize = cellSize / 3;
+        int smallBoxX = x + (cellSize - smallBoxSize) / 2;
+        int smallBoxY = y + (cellSize - smallBoxSize) / 2;
+
+        if (!isRevealed) {
+            // Unrevealed link: draw smaller black box
+            backend->queueRectangle(smallBoxX, smallBoxY, smallBoxSize, smallBoxSize, RenderBackend::Black);
+        } else {
+            // Revealed link: draw colored box based on type
+            if (link.type == 'V') {
+                // Virus: draw red box
+                backend->queueRectangle(smallBoxX, smallBoxY, smallBoxSize, smallBoxSize, RenderBackend::dRed);
+            } else if (link.type == 'D') {
+                // Data: draw green box
+                backend->queueRectangle(smallBoxX, smallBoxY, smallBoxSize, smallBoxSize, RenderBackend::dGreen);
             }
         }
+        return;
+    }
+
+    if (layer != 1) return;
+
+    // Servers and firewalls
+    std::string firewalls = "wm";
+    if (front.boardStates[r][c] == 'S') {
+        backend->queueRectangle(x, y, cellSize-10, cellSize-10, RenderBackend::lBlue);
+    } else if (firewalls.find(front.boardStates[r][c]) != std::string::npos) {
+        backend->queueRectangle(x, y, cellSize-10, cellSize-10, RenderBackend::dRed);
     }
 }
 
 void GraphicsView::update(View::CellUpdate update) {
-    // TODO: Implement cell update logic
-    // This method should update the display when a cell changes
-    if (update.row == 0 || update.row > 7) return;
-    boardStates[update.row-1][update.col] = b->getBoard()[update.row][update.col]->cellRepresentation(game)[0];
-}
+    if (update.row == 0 || update.row > 8) return;
+    const BaseCell &cell = *b->getBoard()[update.row][update.col];
+    char state = cell.cellRepresentation(game)[0];
 
-void GraphicsView::update(View::RevealLinkUpdate update) {
-    // TODO: Implement link reveal update logic
-     LinkManager::LinkKey key{game->getPlayers()[update.playerId],
-                             update.linkId};
-
-    if (!game->getLinkManager().getLink(key).getRevealState()) {
-        for (int i=0; i<nPlayers; ++i) {
-            if (players[i].player == key.player) {
-                players[i].linkRepresentations[update.linkId].type = update.value[0];
-            }
-        }
+    // a downloaded link can linger as a cell's occupant; only count live ones
+    int occupant = -1;
+    linkDat entered;
+    if (cell.isOccupied() && lm->hasLink(cell.getOccupantLink())) {
+        auto key = cell.getOccupantLink();
+        auto &link = lm->getLink(key);
+        occupant = game->getPlayerIndex(*key.player) * 8 + key.id;
+        char type = link.getType() == Link::LinkType::DATA ? 'D' : 'V';
+        entered = {true, link.getStrength(), type, update.row, update.col};
     }
 
-    else {
-        for (int i=0; i<nPlayers; ++i) {
-            if (players[i].player == key.player) {
-                players[i].revealedLinks |= (1 << update.linkId);
+    std::lock_guard<std::mutex> lock{stateMutex};
+    int r = update.row - 1;
+    pending.boardStates[r][update.col] = state;
+    markCell(r, update.col);
+
+    int previous = pending.occupants[r][update.col];
+    if (previous >= 0 && previous != occupant) {
+        // the old occupant left or lost; unless an earlier update already
+        // placed it somewhere else it is off the board
+        linkDat &left = slot(previous);
+        if (left.r == update.row && left.c == update.col) left.onBoard = false;
+    }
+    if (occupant >= 0) {
+        linkDat &link = slot(occupant);
+        if (link.onBoard && (link.r != update.row || link.c != update.col)) {
+            // moved here before its old cell was updated
+            int fromR = link.r - 1;
+            if (fromR >= 0 && fromR < (int)height &&
+                pending.occupants[fromR][link.c] == occupant) {
+                pending.occupants[fromR][link.c] = -1;
             }
+            markCell(fromR, link.c);
         }
+        link = entered;
     }
+    pending.occupants[r][update.col] = occupant;
+}
+
+void GraphicsView::update(View::RevealLinkUpdate update) {
+    std::lock_guard<std::mutex> lock{stateMutex};
+    // the value is the link's true identity, e.g. "D3"; who may see it is
+    // decided when drawing
+    linkDat &link = pending.players[update.playerId].links[update.linkId];
+    if (update.value.size() >= 2) {
+        link.type = update.value[0];
+        std::from_chars(update.value.data() + 1,
+                        update.value.data() + update.value.size(),
+                        link.strength);
+    }
+    // visibility is owned by the engine; cache each observer's row of the
+    // knowledge matrix so drawing is a single bit test
+    for (int i=0; i<nPlayers; ++i) {
+        pending.players[i].revealedLinks = game->getRevealMask(i);
+    }
+    pending.dirtyPanels[update.playerId] = true;
+    markPlayerLinks(update.playerId);
 }
 
 void GraphicsView::update(View::AbilityCountUpdate update) {
-    // TODO: Implement ability count update logic
-    // This method should update the display when ability count changes
-    players[update.playerId].abilitiesLeft -= 1;
+    std::lock_guard<std::mutex> lock{stateMutex};
+    pending.players[update.playerId].abilitiesLeft = update.abilityCount;
+    pending.dirtyPanels[update.playerId] = true;
 }
 
 void GraphicsView::update(View::ScoreUpdate update) {
-    // TODO: Implement score update logic
-    // This method should update the display when scores change
-    players[update.playerId].score = update.score;
+    std::lock_guard<std::mutex> lock{stateMutex};
+    pending.players[update.playerId].score = update.score;
+    pending.dirtyPanels[update.playerId] = true;
 }
 
 void GraphicsView::drawPlayerInfo(int playerIndex, int x, int y) {
-    const PlayerInfo& player = players[playerIndex];
+    const PlayerInfo& player = front.players[playerIndex];
     
     int boxWidth = 250;  // Made wider for rectangular shape
     int boxHeight = 150; // Made shorter for rectangular shape
@@ -181,125 +311,196 @@ void GraphicsView::drawPlayerInfo(int playerIndex, int x, int y) {
     int lineHeight = 15;
     
     // Draw player info box background
-    fillRectangle(x, y, boxWidth, boxHeight, player.colour);
+    backend->queueRectangle(x, y, boxWidth, boxHeight, player.colour);
     
     // Draw border
-    drawLine(x, y, x + boxWidth, y, 2, Black);
-    drawLine(x, y, x, y + boxHeight, 2, Black);
-    drawLine(x + boxWidth, y, x + boxWidth, y + boxHeight, 2, Black);
-    drawLine(x, y + boxHeight, x + boxWidth, y + boxHeight, 2, Black);
+    backend->queueLine(x, y, x + boxWidth, y, 2, RenderBackend::Black);
+    backend->queueLine(x, y, x, y + boxHeight, 2, RenderBackend::Black);
+    backend->queueLine(x + boxWidth, y, x + boxWidth, y + boxHeight, 2, RenderBackend::Black);
+    backend->queueLine(x, y + boxHeight, x + boxWidth, y + boxHeight, 2, RenderBackend::Black);
+    backend->flushBatch();
     
     int textX = x + margin;
     int textY = y + margin + lineHeight;
     
     if (!player.isAlive) {
         // Draw DEAD text
-        drawString(textX, textY, "DEAD");
+        backend->drawString(textX, textY, "DEAD");
         return;
     }
     
     // Draw player info
-    drawString(textX, textY, "Player " + std::to_string(playerIndex + 1));
+    backend->drawString(textX, textY, "Player " + std::to_string(playerIndex + 1));
     textY += lineHeight;
     
     // Draw score
-    drawString(textX, textY, "Downloaded: " + std::to_string(player.score.first) + "D, " + 
+    backend->drawString(textX, textY, "Downloaded: " + std::to_string(player.score.first) + "D, " + 
                std::to_string(player.score.second) + "V");
     textY += lineHeight;
     
     // Draw abilities
-    drawString(textX, textY, "Abilities: " + std::to_string(player.abilitiesLeft));
+    backend->drawString(textX, textY, "Abilities: " + std::to_string(player.abilitiesLeft));
     textY += lineHeight;
     
     // Draw links
-    drawString(textX, textY, "Links:");
+    backend->drawString(textX, textY, "Links:");
     textY += lineHeight;
     
     // Draw first row of links (L1 L2 L3 L4)
     std::string firstRow = "L1 L2 L3 L4: ";
     for (size_t i = 0; i < 4; ++i) {
-        // Always show current player's own links, otherwise check revealed bitmask
-        if (playerIndex == cPlayer || (player.revealedLinks & (1 << i))) {
-            firstRow += std::string(1, player.linkRepresentations[i].type) + 
-                       std::to_string(player.linkRepresentations[i].strength);
+        // Show links the current player knows about
+        if (front.players[front.cPlayer].revealedLinks & (1u << (playerIndex * 8 + i))) {
+            firstRow += std::string(1, player.links[i].type) + 
+                       std::to_string(player.links[i].strength);
         } else {
             firstRow += "?";
         }
         if (i < 3) firstRow += " ";
     }
-    drawString(textX, textY, firstRow);
+    backend->drawString(textX, textY, firstRow);
     textY += lineHeight;
     
     // Draw second row of links (L5 L6 L7 L8)
     std::string secondRow = "L5 L6 L7 L8: ";
     for (size_t i = 4; i < 8; ++i) {
-        // Always show current player's own links, otherwise check revealed bitmask
-        if (playerIndex == cPlayer || (player.revealedLinks & (1 << i))) {
-            secondRow += std::string(1, player.linkRepresentations[i].type) + 
-                        std::to_string(player.linkRepresentations[i].strength);
+        // Show links the current player knows about
+        if (front.players[front.cPlayer].revealedLinks & (1u << (playerIndex * 8 + i))) {
+            secondRow += std::string(1, player.links[i].type) + 
+                        std::to_string(player.links[i].strength);
         } else {
             secondRow += "?";
         }
         if (i < 7) secondRow += " ";
     }
-    drawString(textX, textY, secondRow);
+    backend->drawString(textX, textY, secondRow);
 }
 
 void GraphicsView::display() const {}
 
-void GraphicsView::realdisplay() {
-    // Call the non-const implementation
-    const_cast<GraphicsView*>(this)->displayImpl();
-}
+void GraphicsView::realdisplay() { requestFrame(); }
 
 void GraphicsView::refresh() {
-    for (int i=0; i<nPlayers; ++i) {
-        players[i].linkRepresentations = {};
-        for (unsigned j=0; j<8; ++j) {
-            LinkManager::LinkKey k = {
-                players[i].player,
-                j
-            };
-            if (!lm->hasLink(k)) continue;
-            auto &link = lm->getLink(k);
-            auto [r, c] = link.getCoords();
-            players[i].linkRepresentations.push_back(linkDat{link.getStrength(), 'V', "", r, c});
-            if (link.getType() == Link::LinkType::DATA) {
-                players[i].linkRepresentations[players[i].linkRepresentations.size()-1].type = 'D';
-            }
-
+    {
+        std::lock_guard<std::mutex> lock{stateMutex};
+        // follow the game's turn; the whole window changes perspective
+        int current = game->getPlayerIndex(*game->getCurrentPlayer());
+        if (current != pending.cPlayer) {
+            pending.cPlayer = current;
+            pending.fullRedraw = true;
         }
     }
-    
+    requestFrame();
+}
+
+void GraphicsView::requestFrame() {
+    if (!renderThread.joinable()) {
+        // offscreen: every request is a frame
+        takeSnapshot();
+        displayImpl();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{stateMutex};
+        frameRequested = true;
+    }
+    uint64_t one = 1;
+    write(wakeFd, &one, sizeof(one));
 }
 
-void GraphicsView::nextTurn() {
-    cPlayer = (cPlayer + 1) % nPlayers;
-    clear();
+void GraphicsView::takeSnapshot() {
+    std::lock_guard<std::mutex> lock{stateMutex};
+    front = pending;
+    pending.fullRedraw = false;
+    for (auto& row : pending.dirtyCells) std::fill(row.begin(), row.end(), false);
+    std::fill(pending.dirtyPanels.begin(), pending.dirtyPanels.end(), false);
+    frameRequested = false;
 }
 
-void GraphicsView::displayImpl() {
-    // Clear the window first
-    fillRectangle(0, 0, getWidth(), getHeight(), White);
-    
-    // Draw the board
-    drawBoard();
-    
-    // Draw a title
-    drawString(getWidth() / 2 - 100, 30, "RAII Net");
-    
-    // Draw player info boxes on the right side
-    int infoX = getWidth() - 270;  // 250 width + 20 margin
-    int player1Y = 80;
-    
-    // Draw player info for each player
-    for (int i = 0; i < nPlayers; ++i) {
-        int y = player1Y + i * (150 + 20); // 150 height + 20 margin
-        drawPlayerInfo(i, infoX, y);
+void GraphicsView::renderLoop() {
+    Trace::nameThread("render");
+    using clock = std::chrono::steady_clock;
+    auto nextFrame = clock::now();
+    while (true) {
+        bool exposed = backend->handleEvents();
+        bool wantFrame;
+        {
+            std::lock_guard<std::mutex> lock{stateMutex};
+            if (stopping) return;
+            wantFrame = frameRequested;
+        }
+
+        auto now = clock::now();
+        if (wantFrame && now >= nextFrame) {
+            takeSnapshot();
+            displayImpl();
+            nextFrame = now + frameInterval;
+            continue;
+        }
+        if (exposed) {
+            // the back pixmap is always complete; just copy it again
+            backend->display();
+        }
+
+        // sleep until the X server or an update needs us
+        int timeout = -1;
+        if (wantFrame) {
+            timeout = std::chrono::ceil<std::chrono::milliseconds>(nextFrame - now).count();
+        }
+        pollfd fds[2] = {{backend->getConnectionFd(), POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        poll(fds, 2, timeout);
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            read(wakeFd, &count, sizeof(count));
+        }
     }
-    
-    // Update the display
-    Xwindow::display();
 }
 
+void GraphicsView::displayImpl() {
+    static Timers::Site site{"GraphicsView::displayImpl"};
+    Timers::Scope timer{site};
+    Trace::Span span{"GraphicsView::displayImpl", "render"};
+    if (front.fullRedraw) {
+        // Clear the window first
+        backend->fillRectangle(0, 0, backend->getWidth(), backend->getHeight(), RenderBackend::White);
+
+        // Draw the board
+        drawBoard();
+
+        // Draw a title
+        backend->drawString(backend->getWidth() / 2 - 100, 30, "RAII Net");
+
+        // Draw player info boxes on the right side
+        for (int i = 0; i < nPlayers; ++i) {
+            Rect panel = panelRect(i);
+            drawPlayerInfo(i, panel.x + 1, panel.y + 1);
+        }
+
+        damage.clear();
+        damage.push_back({0, 0, backend->getWidth(), backend->getHeight()});
+    } else {
+        damage.clear();
+        for (int layer = 0; layer < 3; ++layer) {
+            for (unsigned r = 0; r < height; ++r) {
+                for (unsigned c = 0; c < width; ++c) {
+                    if (!front.dirtyCells[r][c]) continue;
+                    drawCell(r, c, layer);
+                    if (layer == 0) damage.push_back(cellRect(r, c));
+                }
+            }
+            backend->flushBatch();
+        }
+        for (int i = 0; i < nPlayers; ++i) {
+            if (!front.dirtyPanels[i]) continue;
+            Rect panel = panelRect(i);
+            drawPlayerInfo(i, panel.x + 1, panel.y + 1);
+            damage.push_back(panel);
+        }
+    }
 
+    // Copy only the damaged regions to the window
+    for (const Rect& rect : damage) {
+        backend->displayArea(rect.x, rect.y, rect.w, rect.h);
+    }
+    backend->flush();
+}
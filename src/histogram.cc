@@ -0,0 +1,65 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <bit>
+
+unsigned Histogram::bucketOf(uint64_t value) {
+    if (value < subBuckets) return value;
+    unsigned exponent = std::bit_width(value) - 1;
+    unsigned shift = exponent - subBits;
+    // the top bit is implied by the exponent; the next subBits pick the
+    // bucket within it
+    return (shift + 1) * subBuckets + ((value >> shift) & (subBuckets - 1));
+}
+
+uint64_t Histogram::highestIn(unsigned bucket) {
+    if (bucket < subBuckets) return bucket;
+    unsigned shift = bucket / subBuckets - 1;
+    uint64_t lowest = uint64_t(subBuckets + bucket % subBuckets) << shift;
+    return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    uint64_t seen = largest.load(std::memory_order_relaxed);
+    while (value > seen &&
+           !largest.compare_exchange_weak(seen, value,
+                                          std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::merge(const Histogram &other) {
+    for (unsigned i = 0; i < buckets; ++i) {
+        uint64_t n = other.counts[i].load(std::memory_order_relaxed);
+        if (n) counts[i].fetch_add(n, std::memory_order_relaxed);
+    }
+    total.fetch_add(other.count(), std::memory_order_relaxed);
+    uint64_t value = other.max();
+    uint64_t seen = largest.load(std::memory_order_relaxed);
+    while (value > seen &&
+           !largest.compare_exchange_weak(seen, value,
+                                          std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::count() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::max() const {
+    return largest.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::percentile(double quantile) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    // rank of the value wanted, counting from 1
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(quantile * n + 0.5));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < buckets; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(highestIn(i), max());
+    }
+    return max();
+}
@@ -15,8 +15,6 @@ Link::~Link() {}
 
 int Link::getStrength() const { return strength; }
 
-bool Link::getRevealState() const { return false; }
-
 std::pair<int, int> Link::getCoords() const { return coords; }
 
 void Link::setCoords(std::pair<int, int> newCoords) { coords = newCoords; }
@@ -82,18 +80,18 @@ DataLink::~DataLink() {}
 
 // Link decorator
 
-LinkDecorator::LinkDecorator(std::unique_ptr<Link> base)
+LinkDecorator::LinkDecorator(ArenaPtr<Link> base)
     : Link(base->getCoords(), base->getStrength(), base->owner, base->board),
       base(std::move(base)) {}
 
+Link* LinkDecorator::getBase() const { return base.get(); }
+
 Link::LinkType LinkDecorator::getType() const { return base->getType(); }
 
 void LinkDecorator::requestMove(Link::Direction dir, Game* game) {
     board->moveLink(getCoords(), getNewCoords(getCoords(), dir), game);
 }
 
-bool LinkDecorator::getRevealState() const { return base->getRevealState(); }
-
 std::pair<int, int> LinkDecorator::getCoords() const {
     return base->getCoords();
 }
@@ -125,19 +123,23 @@ Link::LinkType PolarizeDecorator::getType() const {
     }
 }
 
-// Reveal
-bool RevealDecorator::getRevealState() const { return true; }
-
 // Lag
 // kys
 
 // QuantumEntanglement
 QuantumEntanglementDecorator::QuantumEntanglementDecorator(
-    std::unique_ptr<Link> base, Link* partner)
+    ArenaPtr<Link> base, Link* partner)
     : LinkDecorator(std::move(base)), partner(partner) {}
 
+Link* QuantumEntanglementDecorator::getPartner() const { return partner; }
+
+void QuantumEntanglementDecorator::setPartner(Link* newPartner) {
+    partner = newPartner;
+}
+
 void QuantumEntanglementDecorator::requestMove(Direction dir, Game* game) {
     base->requestMove(dir, game);
+    if (!partner) return;
     try {
         partner->requestMove(dir, game);
     } catch (...) {
@@ -2,6 +2,7 @@
 
 #include <stdexcept>
 
+#include "allocstats.h"
 #include "board.h"
 #include "link.h"
 
@@ -10,7 +11,10 @@ using std::vector;
 
 void LinkManager::addLinksForPlayer(const std::vector<std::string>& links,
                                     Player* player, Board* board) {
-    linkMap[player] = vector<std::unique_ptr<Link>>(links.size());
+    AllocStats::Scope scope{AllocTag::Links};
+    auto &owned = linkMap[player];
+    owned.clear();
+    owned.resize(links.size());
     unsigned i = 0;
     for (auto s : links) {
         // assume placement is of format DX or VX, where D/V indicates data
@@ -19,12 +23,12 @@ void LinkManager::addLinksForPlayer(const std::vector<std::string>& links,
         int strength = s[1] - '0';
         if (s[0] == 'D') {
             std::pair<int, int> sentinel = {0, 0};
-            linkMap[player][i] =
-                std::make_unique<DataLink>(sentinel, strength, player, board);
+            owned[i] = makeArena<DataLink>(arena, sentinel, strength, player,
+                                           board);
         } else {
             std::pair<int, int> sentinel = {0, 0};
-            linkMap[player][i] =
-                std::make_unique<VirusLink>(sentinel, strength, player, board);
+            owned[i] = makeArena<VirusLink>(arena, sentinel, strength, player,
+                                            board);
         }
 
         i++;
@@ -32,13 +36,15 @@ void LinkManager::addLinksForPlayer(const std::vector<std::string>& links,
 }
 
 Link& LinkManager::getLink(LinkKey key) {
+    AllocStats::Scope scope{AllocTag::Links};
     if (!hasLink(key)) throw std::invalid_argument("Link does not exist");
     return *linkMap[key.player][key.id];
 }
 
 bool LinkManager::applyDecorator(
     LinkKey key,
-    std::function<std::unique_ptr<Link>(std::unique_ptr<Link>)>& decorator) {
+    std::function<ArenaPtr<Link>(ArenaPtr<Link>)>& decorator) {
+    AllocStats::Scope scope{AllocTag::Decorators};
     if (!hasLink(key)) return false;
 
     linkMap[key.player][key.id] =
@@ -78,4 +84,5 @@ bool LinkManager::playerIsEmpty(Player *p) {
     return true;
 }
 
-LinkManager::LinkManager() {}
+LinkManager::LinkManager(std::pmr::memory_resource *arena)
+    : arena{arena}, linkMap{arena} {}
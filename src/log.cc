@@ -0,0 +1,89 @@
+#include "log.h"
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+std::atomic<LogLevel> runtimeLevel{LogLevel::Warning};
+
+}  // namespace
+
+StreamSink::StreamSink(std::ostream &out) : out{out} {}
+
+void StreamSink::write(LogLevel level, std::string_view message) {
+    out << Log::levelName(level) << ": " << message << "\n";
+}
+
+FileSink::FileSink(const std::string &path) : file{path}, lines{file} {
+    if (!file) throw std::runtime_error("Cannot write log to " + path);
+}
+
+void FileSink::write(LogLevel level, std::string_view message) {
+    lines.write(level, message);
+    // a log is most wanted after a crash; don't leave lines in the buffer
+    file.flush();
+}
+
+RingSink::RingSink(std::size_t capacity) : capacity{capacity} {}
+
+void RingSink::write(LogLevel level, std::string_view message) {
+    if (capacity == 0) return;
+    if (entries.size() == capacity) entries.pop_front();
+    entries.push_back({level, std::string{message}});
+}
+
+std::vector<RingSink::Entry> RingSink::recent() const {
+    return {entries.begin(), entries.end()};
+}
+
+std::mutex Log::mutex;
+std::shared_ptr<LogSink> Log::sink;
+
+bool Log::enabled(LogLevel level) {
+    return level >= floor &&
+           level >= runtimeLevel.load(std::memory_order_relaxed);
+}
+
+void Log::setLevel(LogLevel level) {
+    runtimeLevel.store(level, std::memory_order_relaxed);
+}
+
+void Log::setSink(std::shared_ptr<LogSink> to) {
+    std::lock_guard<std::mutex> lock{mutex};
+    sink = std::move(to);
+}
+
+LogLevel Log::parseLevel(std::string_view name) {
+    for (auto level : {LogLevel::Debug, LogLevel::Info, LogLevel::Warning,
+                       LogLevel::Error, LogLevel::Off}) {
+        if (name == levelName(level)) return level;
+    }
+    throw std::invalid_argument("No log level " + std::string{name});
+}
+
+std::string_view Log::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug:
+            return "debug";
+        case LogLevel::Info:
+            return "info";
+        case LogLevel::Warning:
+            return "warning";
+        case LogLevel::Error:
+            return "error";
+        default:
+            return "off";
+    }
+}
+
+void Log::emit(LogLevel level, std::string_view message) {
+    static StreamSink standardError{std::cerr};
+    std::lock_guard<std::mutex> lock{mutex};
+    if (sink) {
+        sink->write(level, message);
+    } else {
+        standardError.write(level, message);
+    }
+}
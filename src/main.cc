@@ -1,11 +1,25 @@
 #include <boost/program_options.hpp>
+#include <iostream>
+#include <stdexcept>
 #include <string>
 
 #include "controller.h"
+#include "trace.h"
 
 using std::string;
 
 int main(int argc, char* argv[]) {
-    Controller controller;
-    controller.init(argc, argv);
+    // all console I/O goes through iostreams; skip the stdio sync
+    std::ios::sync_with_stdio(false);
+    try {
+        Controller controller;
+        controller.init(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        // bad options are explained as they are parsed
+        if (*e.what()) std::cerr << e.what() << "\n";
+        Trace::stop();
+        return 1;
+    }
+    // every thread that traced has been joined by now
+    Trace::stop();
 }
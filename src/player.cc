@@ -4,26 +4,33 @@
 
 #include "ability.h"
 #include "link.h"
+#include "trace.h"
 #include "views.h"
 #include "game.h"
 
-Player::Player(std::vector<std::unique_ptr<Ability>> abilities,
-               std::shared_ptr<LinkManager> lm, Game* game)
+Player::Player(std::pmr::vector<ArenaPtr<Ability>> abilities,
+               LinkManager* lm, Game* game)
     : abilities{std::move(abilities)}, abilitiesUsed(0), linkManager{lm}, game{game} {}
 
 std::pair<int, int> Player::getScore() const { return score; }
 
-const std::vector<std::unique_ptr<Ability>>& Player::getAbilities() const {
+const std::pmr::vector<ArenaPtr<Ability>>& Player::getAbilities() const {
     return abilities;
 }
 
-void Player::setScore(std::pair<int, int> newScore) { score = newScore; }
+void Player::setScore(std::pair<int, int> newScore) {
+    score = newScore;
+    game->scoreChanged(*this);
+}
 
 int Player::getAbilitiesUsed() const { return abilitiesUsed; }
 
 void Player::incrementAbilityUse() { abilitiesUsed++; }
 
 void Player::download(LinkManager::LinkKey linkKey) {
+    Trace::Span span{"download", "engine"};
+    // the downloading player learns what they downloaded
+    game->revealLink(linkKey, *this);
     Link& link = linkManager->getLink(linkKey);
     switch (link.getType()) {
         case Link::LinkType::DATA:
@@ -36,5 +43,7 @@ void Player::download(LinkManager::LinkKey linkKey) {
     View::ScoreUpdate scoreUpdate{game->getPlayerIndex(*this),
                                   getScore()};
     game->addUpdate(scoreUpdate);
-    linkManager->removeLink(linkKey);
+    game->scoreChanged(*this);
+    auto coords = link.getCoords();
+    if (linkManager->removeLink(linkKey)) game->linkRemoved(linkKey, coords);
 }
@@ -0,0 +1,205 @@
+#include "replay.h"
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include "ability.h"
+#include "game.h"
+#include "gamestate.h"
+
+namespace {
+constexpr char magic[4] = {'R', 'N', 'R', 'P'};
+constexpr uint8_t version = 1;
+
+constexpr uint8_t abilityTag = 0x80;
+constexpr uint8_t passTag = 0xE0;
+constexpr uint8_t keyframeTag = 0xF0;
+
+void putInt(std::ofstream &out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// Reads from the replay buffer, throwing on truncated files
+class Cursor {
+    const std::vector<uint8_t> &data;
+    size_t pos;
+
+   public:
+    Cursor(const std::vector<uint8_t> &data, size_t pos)
+        : data{data}, pos{pos} {}
+
+    size_t offset() const { return pos; }
+    bool done() const { return pos >= data.size(); }
+
+    const uint8_t *take(size_t n) {
+        if (data.size() - pos < n) {
+            throw std::invalid_argument("Replay file is truncated");
+        }
+        const uint8_t *p = data.data() + pos;
+        pos += n;
+        return p;
+    }
+
+    uint64_t getInt(int bytes) {
+        const uint8_t *p = take(bytes);
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) value |= uint64_t(p[i]) << (8 * i);
+        return value;
+    }
+};
+
+void readAbility(Cursor &in, uint8_t tag, int &id, AbilityArgs &args) {
+    id = tag & 0x0F;
+    uint8_t countByte = in.getInt(1);
+    args.count = countByte & 0x3F;
+    for (unsigned i = 0; i < args.count && i < AbilityArgs::maxArgs; ++i) {
+        args.linkIds[i] = static_cast<char>(in.getInt(1));
+        args.values[i] = static_cast<int8_t>(in.getInt(1));
+        args.numeric[i] = countByte & (0x40 << i);
+    }
+}
+}  // namespace
+
+ReplayWriter::ReplayWriter(const std::string &path, const ReplayHeader &header)
+    : out{path, std::ios::binary | std::ios::trunc},
+      interval{header.keyframeInterval} {
+    if (!out) {
+        throw std::invalid_argument("Cannot create replay file " + path);
+    }
+    out.write(magic, sizeof(magic));
+    putInt(out, version, 1);
+    putInt(out, header.abilities.size(), 1);
+    putInt(out, header.keyframeInterval, 2);
+    putInt(out, header.seed, 8);
+    putInt(out, sizeof(GameState), 4);
+    for (unsigned i = 0; i < header.abilities.size(); ++i) {
+        putInt(out, header.abilities[i].size(), 1);
+        out << header.abilities[i];
+        putInt(out, header.placements[i].size(), 1);
+        for (const auto &placement : header.placements[i]) {
+            out.write(placement.data(), 2);
+        }
+    }
+}
+
+void ReplayWriter::recordMove(const Game &game, unsigned link,
+                              Link::Direction dir) {
+    putInt(out, (link & 0x07) | (static_cast<unsigned>(dir) << 3), 1);
+    keyframeIfDue(game);
+}
+
+void ReplayWriter::recordPass(const Game &game) {
+    putInt(out, passTag, 1);
+    keyframeIfDue(game);
+}
+
+void ReplayWriter::keyframeIfDue(const Game &game) {
+    if (interval && game.getTurn() % interval == 0) {
+        GameState state = GameState::capture(game);
+        putInt(out, keyframeTag, 1);
+        putInt(out, game.getTurn(), 4);
+        out.write(reinterpret_cast<const char *>(&state), sizeof(state));
+    }
+}
+
+void ReplayWriter::recordAbility(int id, const AbilityArgs &args) {
+    uint8_t countByte = args.count < 0x3F ? args.count : 0x3F;
+    for (unsigned i = 0; i < args.count && i < AbilityArgs::maxArgs; ++i) {
+        if (args.numeric[i]) countByte |= 0x40 << i;
+    }
+    putInt(out, abilityTag | (id & 0x0F), 1);
+    putInt(out, countByte, 1);
+    for (unsigned i = 0; i < args.count && i < AbilityArgs::maxArgs; ++i) {
+        putInt(out, static_cast<uint8_t>(args.linkIds[i]), 1);
+        putInt(out, static_cast<uint8_t>(args.values[i]), 1);
+    }
+}
+
+void ReplayWriter::flush() { out.flush(); }
+
+ReplayReader::ReplayReader(const std::string &path) {
+    std::ifstream in{path, std::ios::binary};
+    if (!in) {
+        throw std::invalid_argument("File " + path + " not found");
+    }
+    data.assign(std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+
+    Cursor cursor{data, 0};
+    if (std::memcmp(cursor.take(sizeof(magic)), magic, sizeof(magic)) != 0) {
+        throw std::invalid_argument(path + " is not a replay file");
+    }
+    if (cursor.getInt(1) != version) {
+        throw std::invalid_argument(path + " has an unsupported version");
+    }
+    unsigned players = cursor.getInt(1);
+    header.keyframeInterval = cursor.getInt(2);
+    header.seed = cursor.getInt(8);
+    if (cursor.getInt(4) != sizeof(GameState)) {
+        throw std::invalid_argument(path + " was recorded by another build");
+    }
+    for (unsigned i = 0; i < players; ++i) {
+        unsigned length = cursor.getInt(1);
+        const uint8_t *letters = cursor.take(length);
+        header.abilities.emplace_back(letters, letters + length);
+        unsigned count = cursor.getInt(1);
+        auto &placements = header.placements.emplace_back();
+        for (unsigned j = 0; j < count; ++j) {
+            const uint8_t *placement = cursor.take(2);
+            placements.emplace_back(placement, placement + 2);
+        }
+    }
+    recordsStart = cursor.offset();
+}
+
+const ReplayHeader &ReplayReader::getHeader() const { return header; }
+
+unsigned ReplayReader::seek(Game &game, unsigned turn) const {
+    // find the last keyframe at or before the turn without applying anything
+    size_t start = recordsStart;
+    size_t keyframe = 0;
+    Cursor scan{data, recordsStart};
+    while (!scan.done()) {
+        uint8_t tag = scan.getInt(1);
+        if (tag == keyframeTag) {
+            size_t at = scan.offset();
+            unsigned keyTurn = scan.getInt(4);
+            scan.take(sizeof(GameState));
+            if (keyTurn > turn) break;
+            keyframe = at;
+            start = scan.offset();
+        } else if (tag != passTag && (tag & abilityTag)) {
+            int id;
+            AbilityArgs args;
+            readAbility(scan, tag, id, args);
+        }
+    }
+
+    if (keyframe) {
+        GameState state;
+        std::memcpy(&state, data.data() + keyframe + 4, sizeof(state));
+        state.restore(game);
+    }
+
+    Cursor in{data, start};
+    while (!in.done() && game.getTurn() < turn && !game.checkWinLoss()) {
+        uint8_t tag = in.getInt(1);
+        if (tag == keyframeTag) {
+            in.take(4 + sizeof(GameState));
+        } else if (tag == passTag) {
+            game.nextTurn();
+        } else if (tag & abilityTag) {
+            int id;
+            AbilityArgs args;
+            readAbility(in, tag, id, args);
+            game.useAbility(id, args);
+        } else {
+            game.makeMove(tag & 0x07, static_cast<Link::Direction>(tag >> 3));
+        }
+    }
+    game.flushUpdates();
+    return game.getTurn();
+}
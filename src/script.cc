@@ -0,0 +1,94 @@
+#include "script.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+constexpr std::string_view blank = " \t\r";
+
+bool isBlank(std::string_view command) {
+    return command.find_first_not_of(blank) == std::string_view::npos;
+}
+}  // namespace
+
+Script::Script(std::string path) : path{std::move(path)} {
+    int fd = open(this->path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::invalid_argument("File " + this->path + " not found");
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        throw std::invalid_argument("Cannot read " + this->path);
+    }
+    mtime = info.st_mtim;
+    size = info.st_size;
+    if (size > 0) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = nullptr;
+            close(fd);
+            throw std::invalid_argument("Cannot map " + this->path);
+        }
+    }
+    close(fd);
+
+    std::string_view text{static_cast<const char *>(data), size};
+    while (!text.empty()) {
+        std::size_t lineEnd = text.find('\n');
+        std::string_view line = text.substr(0, lineEnd);
+        text.remove_prefix(lineEnd == std::string_view::npos ? text.size()
+                                                             : lineEnd + 1);
+        while (true) {
+            std::size_t end = line.find(';');
+            std::string_view command = line.substr(0, end);
+            if (!isBlank(command)) commands.push_back(command);
+            if (end == std::string_view::npos) break;
+            line.remove_prefix(end + 1);
+        }
+    }
+}
+
+Script::~Script() {
+    if (data) munmap(data, size);
+}
+
+const std::string &Script::getPath() const { return path; }
+
+const std::vector<std::string_view> &Script::getCommands() const {
+    return commands;
+}
+
+bool Script::isStale(const timespec &current, std::size_t currentSize) const {
+    return current.tv_sec != mtime.tv_sec || current.tv_nsec != mtime.tv_nsec ||
+           currentSize != size;
+}
+
+std::string ScriptCache::resolve(std::string_view path) {
+    std::string name{path};
+    char resolved[PATH_MAX];
+    if (name.empty() || !realpath(name.c_str(), resolved)) {
+        throw std::invalid_argument("File " + name + " not found");
+    }
+    return resolved;
+}
+
+const Script &ScriptCache::get(const std::string &canonical) {
+    auto &script = scripts[canonical];
+    struct stat info;
+    if (stat(canonical.c_str(), &info) < 0) {
+        scripts.erase(canonical);
+        throw std::invalid_argument("File " + canonical + " not found");
+    }
+    if (!script || script->isStale(info.st_mtim, info.st_size)) {
+        script.reset();
+        script = std::make_unique<Script>(canonical);
+    }
+    return *script;
+}
@@ -0,0 +1,397 @@
+#include "server.h"
+
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include "eventloop.h"
+#include "game.h"
+#include "histogram.h"
+#include "trace.h"
+
+namespace {
+constexpr std::size_t readChunk = 1 << 16;
+constexpr unsigned seatsPerGame = 2; /**< Players in every game. */
+}  // namespace
+
+/**
+ * @brief One player's connection to a session.
+ */
+struct GameServer::Seat {
+    int fd;                  /**< The client's socket. */
+    std::ostringstream view; /**< The player's board, as its TextView
+                                prints it. */
+    std::vector<char> input; /**< Bytes received but not yet run. */
+    std::size_t filled = 0;  /**< Bytes of input in use. */
+    std::string pending;     /**< Messages not yet sent. */
+    std::size_t sent = 0;    /**< Bytes of pending already sent. */
+    bool waitingToWrite = false; /**< Whether the socket was full. */
+
+    explicit Seat(int fd) : fd{fd} {}
+    ~Seat() { close(fd); }
+
+    /**
+     * @brief Queues a message made of shared text and the player's board.
+     * @param text What the game printed for every seat.
+     */
+    void message(std::string_view text) {
+        pending += text;
+        pending += std::move(view).str();
+        pending += '\0';
+        view.str({});
+    }
+};
+
+/**
+ * @brief A game and the connections playing it, one seat per player.
+ */
+struct GameServer::Session {
+    std::ostringstream out;     /**< Collects what the game prints for
+                                   every seat. */
+    Controller controller{out}; /**< The session's game. */
+    std::vector<std::unique_ptr<Seat>> seats; /**< Indexed by player. */
+    bool closing = false; /**< Whether to close once messages are sent. */
+
+    /**
+     * @brief Takes what the game printed for every seat.
+     * @return The text, which is cleared from out.
+     */
+    std::string takeShared() {
+        std::string text = std::move(out).str();
+        out.str({});
+        return text;
+    }
+};
+
+/**
+ * @brief A worker thread and the sessions it owns. Everything except the
+ * loop's post() is touched only by the worker thread while it runs.
+ */
+struct GameServer::Worker {
+    EventLoop loop;
+    std::thread thread;
+    std::unordered_map<Session *, std::unique_ptr<Session>> sessions;
+    uint64_t commands = 0; /**< Command lines run. */
+    Histogram latencies; /**< Time to run each command, in nanoseconds. */
+
+    /**
+     * @brief Starts a game for a group of connections, the first playing
+     * player 1.
+     */
+    void adopt(std::vector<int> fds, const GameConfig &config) {
+        auto session = std::make_unique<Session>();
+        Session &s = *session;
+        for (unsigned i = 0; i < fds.size(); ++i) {
+            s.seats.push_back(std::make_unique<Seat>(fds[i]));
+            s.controller.setSeatOutput(i, s.seats[i]->view);
+        }
+        try {
+            s.controller.start(config);
+            // the player to move is shown the board to move on
+            s.controller.display();
+        } catch (const std::exception &e) {
+            s.out << "Cannot start game: " << e.what() << "\n";
+            s.closing = true;
+        }
+        std::string text = s.takeShared();
+        for (unsigned i = 0; i < s.seats.size(); ++i) {
+            s.seats[i]->pending =
+                "You are player " + std::to_string(i + 1) + ".\n";
+            s.seats[i]->message(text);
+        }
+        sessions[&s] = std::move(session);
+        for (auto &seat : s.seats) {
+            Seat &t = *seat;
+            loop.watch(t.fd, [this, &s, &t] { onReady(s, t); });
+        }
+        flushAll(s);
+    }
+
+    /**
+     * @brief Sends what it can of a seat's messages.
+     * @return True once everything has been sent.
+     */
+    bool flush(Session &s, Seat &t) {
+        while (t.sent < t.pending.size()) {
+            ssize_t n = send(t.fd, t.pending.data() + t.sent,
+                             t.pending.size() - t.sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!t.waitingToWrite) loop.setWritable(t.fd, true);
+                t.waitingToWrite = true;
+                return false;
+            }
+            if (n < 0) {
+                // the client went away; nothing more can be sent
+                s.closing = true;
+                t.pending.clear();
+                t.sent = 0;
+                return true;
+            }
+            t.sent += n;
+        }
+        t.pending.clear();
+        t.sent = 0;
+        if (t.waitingToWrite) loop.setWritable(t.fd, false);
+        t.waitingToWrite = false;
+        return true;
+    }
+
+    /**
+     * @brief Checks whether every seat has been sent its messages.
+     */
+    static bool flushed(const Session &s) {
+        return std::all_of(s.seats.begin(), s.seats.end(),
+                           [](const auto &t) { return t->pending.empty(); });
+    }
+
+    /**
+     * @brief Runs one line from a seat. Only the player to move may play;
+     * the others are told to wait. The sender gets what the game printed
+     * and its own board, and once the turn passes or the game ends, every
+     * other seat gets the same text and, if it is now to move, its board.
+     */
+    void runLine(Session &s, unsigned player, std::string_view line) {
+        Seat &t = *s.seats[player];
+        const Game &game = s.controller.getGame();
+        if (game.getCurrentPlayerIndex() != player) {
+            t.message("Not your turn.\n");
+            return;
+        }
+
+        auto begun = std::chrono::steady_clock::now();
+        s.controller.runCommands(line);
+        s.controller.updateViews();
+        auto took = std::chrono::steady_clock::now() - begun;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(took);
+        latencies.record(ns.count());
+        ++commands;
+
+        std::string text = s.takeShared();
+        t.message(text);
+        unsigned next = game.getCurrentPlayerIndex();
+        if (s.controller.isRunning() && next == player) return;
+        if (s.controller.isRunning()) s.controller.display();
+        for (unsigned i = 0; i < s.seats.size(); ++i) {
+            if (i != player) s.seats[i]->message(text);
+        }
+    }
+
+    /**
+     * @brief Handles a readable or writable seat socket.
+     */
+    void onReady(Session &s, Seat &t) {
+        // stop reading while the client is not taking its messages
+        if (!flush(s, t)) return;
+        if (s.closing) {
+            if (flushed(s)) end(s);
+            return;
+        }
+
+        if (t.filled == t.input.size()) {
+            t.input.resize(std::max(t.input.size() * 2, readChunk));
+        }
+        ssize_t n = recv(t.fd, t.input.data() + t.filled,
+                         t.input.size() - t.filled, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                      errno == EINTR)) {
+            return;
+        }
+        unsigned player = 0;
+        while (s.seats[player].get() != &t) ++player;
+        if (n <= 0) {
+            // a game cannot go on with a seat empty
+            t.pending.clear();
+            t.sent = 0;
+            for (auto &seat : s.seats) {
+                if (seat.get() == &t) continue;
+                seat->message("Player " + std::to_string(player + 1) +
+                              " left.\n");
+            }
+            s.closing = true;
+            flushAll(s);
+            return;
+        }
+        t.filled += n;
+
+        std::size_t start = 0;
+        while (s.controller.isRunning()) {
+            const char *begin = t.input.data() + start;
+            auto newline = static_cast<const char *>(
+                std::memchr(begin, '\n', t.filled - start));
+            if (!newline) break;
+            std::string_view line{begin, std::size_t(newline - begin)};
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            runLine(s, player, line);
+            start = newline - t.input.data() + 1;
+        }
+        std::memmove(t.input.data(), t.input.data() + start, t.filled - start);
+        t.filled -= start;
+
+        if (!s.controller.isRunning()) s.closing = true;
+        flushAll(s);
+    }
+
+    /**
+     * @brief Sends what it can to every seat, and closes the session once
+     * it is over and everything has been sent.
+     */
+    void flushAll(Session &s) {
+        bool done = true;
+        for (auto &seat : s.seats) done = flush(s, *seat) && done;
+        if (done && s.closing) end(s);
+    }
+
+    /**
+     * @brief Closes a session and every seat. The session is destroyed.
+     */
+    void end(Session &s) {
+        for (auto &seat : s.seats) loop.unwatch(seat->fd);
+        sessions.erase(&s);
+    }
+};
+
+GameServer::GameServer(const GameConfig &config, std::string socketPath,
+                       unsigned workerCount)
+    : config{config}, socketPath{std::move(socketPath)} {
+    baseSeed = config.seed ? *config.seed : std::random_device{}();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (this->socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long");
+    }
+    std::strcpy(address.sun_path, this->socketPath.c_str());
+
+    // replace a socket left behind by a server that did not shut down
+    struct stat info;
+    if (stat(address.sun_path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(address.sun_path);
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 ||
+        bind(listenFd, reinterpret_cast<sockaddr *>(&address),
+             sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0) {
+        std::string reason = std::strerror(errno);
+        if (listenFd >= 0) close(listenFd);
+        throw std::runtime_error("Cannot listen on " + this->socketPath +
+                                 ": " + reason);
+    }
+
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+GameServer::~GameServer() {
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->loop.post([&loop = worker->loop] { loop.stop(); });
+            worker->thread.join();
+        }
+    }
+    workers.clear();
+    for (int fd : waiting) close(fd);
+    close(listenFd);
+    unlink(socketPath.c_str());
+}
+
+void GameServer::acceptSessions() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            // EAGAIN once the backlog is empty; anything else (such as
+            // running out of descriptors) is retried on the next wakeup
+            return;
+        }
+        // each game waits until it has a connection for every seat
+        waiting.push_back(fd);
+        if (waiting.size() < seatsPerGame) continue;
+        GameConfig session = config;
+        session.seed = baseSeed + sessionsStarted++;
+        // clients must not reach the server's files through the game
+        session.fileCommands = false;
+        Worker *worker = workers[nextWorker].get();
+        nextWorker = (nextWorker + 1) % workers.size();
+        worker->loop.post([worker, fds = std::move(waiting), session] {
+            worker->adopt(fds, session);
+        });
+        waiting.clear();
+    }
+}
+
+void GameServer::run() {
+    // only the signalfd below sees these; workers inherit the mask
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    int signalFd = signalfd(-1, &signals, SFD_CLOEXEC | SFD_NONBLOCK);
+    if (signalFd < 0) {
+        throw std::runtime_error("Cannot create signalfd");
+    }
+
+    for (unsigned i = 0; i < workers.size(); ++i) {
+        workers[i]->thread = std::thread([&loop = workers[i]->loop, i] {
+            Trace::nameThread("worker " + std::to_string(i + 1));
+            loop.run();
+        });
+    }
+
+    EventLoop loop;
+    loop.watch(listenFd, [this] { acceptSessions(); });
+    loop.watch(signalFd, [&loop] { loop.stop(); });
+    std::cout << "Serving games on " << socketPath << " with "
+              << workers.size() << " workers" << std::endl;
+
+    auto started = std::chrono::steady_clock::now();
+    loop.run();
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - started)
+                         .count();
+    close(signalFd);
+
+    for (auto &worker : workers) {
+        worker->loop.post([&loop = worker->loop] { loop.stop(); });
+        worker->thread.join();
+    }
+    report(seconds);
+}
+
+void GameServer::report(double seconds) const {
+    Histogram all;
+    uint64_t commands = 0;
+    for (const auto &worker : workers) {
+        commands += worker->commands;
+        all.merge(worker->latencies);
+    }
+    std::cout << "Served " << sessionsStarted << " sessions, " << commands
+              << " commands in " << seconds << " s ("
+              << (seconds > 0 ? commands / seconds : 0) << " commands/s)\n";
+    if (all.count() == 0) return;
+
+    std::cout << "Command latency (us):";
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        std::cout << " p" << q * 100 << " " << all.percentile(q) / 1000.0;
+    }
+    std::cout << " max " << all.max() / 1000.0 << std::endl;
+}
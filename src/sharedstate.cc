@@ -0,0 +1,116 @@
+#include "sharedstate.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+std::string segmentName(std::string name) {
+    if (name.empty() || name.front() != '/') name.insert(0, 1, '/');
+    return name;
+}
+
+}  // namespace
+
+StatePublisher::StatePublisher(std::string name)
+    : name{segmentName(std::move(name))} {
+    // a new segment each run: readers still holding an old one keep it intact
+    shm_unlink(this->name.c_str());
+    int fd = shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                      0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create shared memory " + this->name +
+                                 ": " + std::strerror(errno));
+    }
+    void *memory = MAP_FAILED;
+    if (ftruncate(fd, sizeof(SharedState)) == 0) {
+        memory = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(this->name.c_str());
+        throw std::runtime_error("Cannot map shared memory " + this->name +
+                                 ": " + std::strerror(error));
+    }
+
+    shared = new (memory) SharedState{};
+    shared->layout = SharedState::version;
+    shared->stateSize = sizeof(GameState);
+    std::memcpy(shared->tag, SharedState::magic, sizeof(shared->tag));
+}
+
+StatePublisher::~StatePublisher() {
+    shared->~SharedState();
+    munmap(shared, sizeof(SharedState));
+    shm_unlink(name.c_str());
+}
+
+const std::string &StatePublisher::getName() const { return name; }
+
+void StatePublisher::publish(const Game &game) {
+    GameState::capture(game, staging);
+    uint32_t sequence = shared->sequence.load(std::memory_order_relaxed);
+    shared->sequence.store(sequence + 1, std::memory_order_relaxed);
+    // the odd sequence must be visible before any byte of the new state
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&shared->state, &staging, sizeof(GameState));
+    shared->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+StateSubscriber::StateSubscriber(std::string name) {
+    name = segmentName(std::move(name));
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open shared memory " + name + ": " +
+                                 std::strerror(errno));
+    }
+    void *memory = MAP_FAILED;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size >= off_t(sizeof(SharedState))) {
+        memory = mmap(nullptr, sizeof(SharedState), PROT_READ, MAP_SHARED, fd,
+                      0);
+    }
+    close(fd);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("Shared memory " + name +
+                                 " is not a game state");
+    }
+    shared = static_cast<const SharedState *>(memory);
+    if (std::memcmp(shared->tag, SharedState::magic, sizeof(shared->tag)) ||
+        shared->layout != SharedState::version ||
+        shared->stateSize != sizeof(GameState)) {
+        munmap(const_cast<SharedState *>(shared), sizeof(SharedState));
+        throw std::runtime_error("Shared memory " + name +
+                                 " was written by another version");
+    }
+}
+
+StateSubscriber::~StateSubscriber() {
+    munmap(const_cast<SharedState *>(shared), sizeof(SharedState));
+}
+
+uint32_t StateSubscriber::getSequence() const {
+    return shared->sequence.load(std::memory_order_acquire);
+}
+
+uint32_t StateSubscriber::read(GameState &state) const {
+    while (true) {
+        uint32_t before = shared->sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        std::memcpy(&state, &shared->state, sizeof(GameState));
+        // the copy must complete before the sequence is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shared->sequence.load(std::memory_order_relaxed) == before) {
+            return before;
+        }
+    }
+}
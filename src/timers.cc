@@ -0,0 +1,44 @@
+#include "timers.h"
+
+#ifdef TIMERS
+#include <atomic>
+#include <iomanip>
+
+namespace {
+
+std::atomic<Timers::Site *> sites{nullptr};  // most recently registered first
+
+}  // namespace
+
+Timers::Site::Site(const char *name)
+    : name{name}, next{sites.load(std::memory_order_relaxed)} {
+    while (!sites.compare_exchange_weak(next, this,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+}
+
+void Timers::print(std::ostream &out) {
+    out << "Latency by site (us):\n"
+        << std::left << std::setw(36) << "site" << std::right
+        << std::setw(10) << "count" << std::setw(10) << "p50"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+    for (Site *site = sites.load(std::memory_order_acquire); site;
+         site = site->next) {
+        const Histogram &h = site->elapsed;
+        out << std::left << std::setw(36) << site->name << std::right
+            << std::setw(10) << h.count() << std::setw(10)
+            << h.percentile(0.5) / 1000.0 << std::setw(10)
+            << h.percentile(0.99) / 1000.0 << std::setw(10)
+            << h.max() / 1000.0 << "\n";
+    }
+}
+
+#else
+
+void Timers::print(std::ostream &out) {
+    out << "Timers are off; rebuild with `make clean` and "
+           "`make TIMERS=1`.\n";
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include "tokenizer.h"
+
+#include <charconv>
+
+namespace {
+constexpr std::string_view whitespace = " \t\r\n\v\f";
+}
+
+Tokenizer::Tokenizer(std::string_view line) : rest{line} {}
+
+std::string_view Tokenizer::next() {
+    auto start = rest.find_first_not_of(whitespace);
+    if (start == std::string_view::npos) {
+        rest = {};
+        return {};
+    }
+    rest.remove_prefix(start);
+    auto end = rest.find_first_of(whitespace);
+    if (end == std::string_view::npos) end = rest.size();
+    std::string_view token = rest.substr(0, end);
+    rest.remove_prefix(end);
+    return token;
+}
+
+bool Tokenizer::nextInt(int &value) { return toInt(next(), value); }
+
+bool Tokenizer::empty() const {
+    return rest.find_first_not_of(whitespace) == std::string_view::npos;
+}
+
+bool Tokenizer::toInt(std::string_view token, int &value) {
+    if (token.empty()) return false;
+    auto [end, ec] =
+        std::from_chars(token.data(), token.data() + token.size(), value);
+    return ec == std::errc{} && end == token.data() + token.size();
+}
@@ -0,0 +1,193 @@
+#include "trace.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief A finished span.
+ */
+struct Event {
+    std::string_view name;
+    const char *category;
+    int64_t start;    /**< Ticks since tracing started. */
+    int64_t duration; /**< Ticks. */
+};
+
+constexpr std::size_t ringSize = 1 << 15;  // spans kept per thread
+
+/**
+ * @brief One thread's spans. Only the owning thread writes to it; stop()
+ * reads it once that thread is done.
+ */
+struct Ring {
+    unsigned tid;           /**< Thread id shown in the trace. */
+    std::string threadName; /**< Empty if the thread was not named. */
+    std::array<Event, ringSize> events;
+    std::atomic<uint64_t> written{0}; /**< Spans ever recorded. */
+};
+
+std::atomic<bool> tracing{false};
+Clock::time_point origin;
+int64_t originTicks;
+std::string tracePath;
+
+std::mutex ringsMutex;  // guards the list, not the rings in it
+std::vector<std::unique_ptr<Ring>> rings;
+thread_local Ring *ring = nullptr;
+
+Ring &localRing() {
+    if (!ring) {
+        auto made = std::make_unique<Ring>();
+        std::lock_guard<std::mutex> lock{ringsMutex};
+        made->tid = rings.size() + 1;
+        ring = made.get();
+        rings.push_back(std::move(made));
+    }
+    return *ring;
+}
+
+// the time stamp counter is a few times cheaper to read than the clock;
+// stop() converts ticks to time by comparing the two over the whole trace
+int64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+void appendString(std::string &out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+void appendNumber(std::string &out, auto value) {
+    char buffer[32];
+    auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    out.append(buffer, end);
+}
+
+// microseconds with nanosecond precision, as the trace format expects
+void appendMicros(std::string &out, double micros) {
+    char buffer[32];
+    auto end = std::to_chars(buffer, buffer + sizeof(buffer), micros,
+                             std::chars_format::fixed, 3)
+                   .ptr;
+    out.append(buffer, end);
+}
+
+}  // namespace
+
+Trace::Span::Span(std::string_view name, const char *category)
+    : name{name},
+      category{category},
+      started{tracing.load(std::memory_order_relaxed) ? ticks() - originTicks
+                                                      : -1} {}
+
+Trace::Span::~Span() {
+    if (started < 0) return;
+    Ring &r = localRing();
+    uint64_t at = r.written.load(std::memory_order_relaxed);
+    r.events[at % ringSize] = {name, category, started,
+                               ticks() - originTicks - started};
+    r.written.store(at + 1, std::memory_order_release);
+}
+
+void Trace::start(std::string path) {
+    tracePath = std::move(path);
+    origin = Clock::now();
+    originTicks = ticks();
+    tracing.store(true, std::memory_order_relaxed);
+    nameThread("controller");
+}
+
+void Trace::stop() {
+    if (!tracing.exchange(false)) return;
+    double elapsed =
+        std::chrono::duration<double, std::micro>(Clock::now() - origin)
+            .count();
+    int64_t elapsedTicks = ticks() - originTicks;
+    double microsPerTick = elapsedTicks > 0 ? elapsed / elapsedTicks : 0;
+
+    std::ofstream file{tracePath};
+    if (!file) {
+        throw std::runtime_error("Cannot write trace to " + tracePath);
+    }
+    // built in memory and written in large pieces; there can be many spans
+    std::string out;
+    auto flush = [&] {
+        file.write(out.data(), out.size());
+        out.clear();
+    };
+    std::string pid;
+    appendNumber(pid, getpid());
+    uint64_t dropped = 0;
+    out += "{\"traceEvents\":[\n";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid +
+           ",\"args\":{\"name\":\"RAIInet\"}}";
+
+    std::lock_guard<std::mutex> lock{ringsMutex};
+    for (const auto &r : rings) {
+        if (!r->threadName.empty()) {
+            out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid +
+                   ",\"tid\":";
+            appendNumber(out, r->tid);
+            out += ",\"args\":{\"name\":";
+            appendString(out, r->threadName);
+            out += "}}";
+        }
+        uint64_t written = r->written.load(std::memory_order_acquire);
+        uint64_t first = written > ringSize ? written - ringSize : 0;
+        dropped += first;
+        for (uint64_t i = first; i < written; ++i) {
+            const Event &event = r->events[i % ringSize];
+            out += ",\n{\"name\":";
+            appendString(out, event.name);
+            out += ",\"cat\":";
+            appendString(out, event.category);
+            out += ",\"ph\":\"X\",\"pid\":" + pid + ",\"tid\":";
+            appendNumber(out, r->tid);
+            out += ",\"ts\":";
+            appendMicros(out, event.start * microsPerTick);
+            out += ",\"dur\":";
+            appendMicros(out, event.duration * microsPerTick);
+            out += '}';
+            if (out.size() > (1 << 16)) flush();
+        }
+    }
+    out += "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":";
+    appendNumber(out, dropped);
+    out += "}}\n";
+    flush();
+    if (!file) {
+        throw std::runtime_error("Cannot write trace to " + tracePath);
+    }
+}
+
+void Trace::nameThread(std::string name) {
+    // a ring is large; threads only get one when there is a trace
+    if (!tracing.load(std::memory_order_relaxed)) return;
+    localRing().threadName = std::move(name);
+}
@@ -12,11 +12,22 @@
 #include "link.h"
 #include "window.h"
 #include "linkmanager.h"
+#include "player.h"
+#include "timers.h"
+#include "trace.h"
 
 View::View(const Game *game, const Player *viewer)
     : players(), viewer(viewer), game(game) {
-    for (unsigned id = 0; id < game->getPlayers().size(); ++id) {
-        players.push_back({id, 5, {0, 0}});
+    // start from the model's current state; a game may have been resumed
+    auto all = game->getPlayers();
+    for (unsigned id = 0; id < all.size(); ++id) {
+        if (!all[id]) {
+            players.push_back({id, 0, {0, 0}});
+            continue;
+        }
+        int abilities =
+            all[id]->getAbilities().size() - all[id]->getAbilitiesUsed();
+        players.push_back({id, abilities, all[id]->getScore()});
     }
 }
 
@@ -40,10 +51,11 @@ char View::findBase(int index) {
     }
 }
 
-TextView::TextView(const Game *game, const Player *viewer)
+TextView::TextView(const Game *game, const Player *viewer, std::ostream &out)
     : View(game, viewer),
       board(game->getBoard().getBoard().size(),
-            std::vector<std::string>(game->getBoard().getBoard()[0].size())) {
+            std::vector<std::string>(game->getBoard().getBoard()[0].size())),
+      out{out} {
     for (unsigned i = 0; i < board.size(); ++i) {
         for (unsigned j = 0; j < board[0].size(); ++j) {
             board[i][j] =
@@ -51,20 +63,18 @@ TextView::TextView(const Game *game, const Player *viewer)
         }
     }
 
+    unsigned viewerId = game->getPlayerIndex(*viewer);
     for (auto &player : players) {
         char base = findBase(player.id);
-        if (game->getPlayerIndex(*viewer) != player.id) {
-            for (int i = 0; i < 8; ++i) {
-                player.links[std::string(1, base + i)] = " ?";
+        for (unsigned i = 0; i < 8; ++i) {
+            std::string &value = player.links[std::string(1, base + i)];
+            if (!game->isRevealedTo(viewerId, player.id, i)) {
+                value = " ?";
+                continue;
             }
-            continue;
-        }
-
-        for (int i = 0; i < 8; ++i) {
             const auto &link = game->getPlayerLink(player.id, i);
-            player.links[std::string(1, base + i)] =
-                (link.first == Link::LinkType::DATA ? "D" : "V") +
-                std::to_string(link.second);
+            value = (link.first == Link::LinkType::DATA ? "D" : "V") +
+                    std::to_string(link.second);
         }
     }
 }
@@ -75,10 +85,8 @@ void TextView::update(View::CellUpdate update) {
 }
 
 void TextView::update(View::RevealLinkUpdate update) {
-    LinkManager::LinkKey key{game->getPlayers()[update.playerId],
-                             update.linkId};
-    if (key.player != viewer &&
-        !game->getLinkManager().getLink(key).getRevealState()) {
+    if (!game->isRevealedTo(game->getPlayerIndex(*viewer), update.playerId,
+                            update.linkId)) {
         return;
     }
     char base = findBase(update.playerId);
@@ -95,18 +103,21 @@ void TextView::update(View::ScoreUpdate update) {
 }
 
 void TextView::printPlayer(PlayerStats player) const {
-    std::cout << "Player " << player.id + 1 << ":" << std::endl;
-    std::cout << "Downloaded: " << player.score.first << "D, "
+    out << "Player " << player.id + 1 << ":" << std::endl;
+    out << "Downloaded: " << player.score.first << "D, "
               << player.score.second << "V" << std::endl;
-    std::cout << "Abilities: " << player.abilities << std::endl;
+    out << "Abilities: " << player.abilities << std::endl;
     for (auto link : player.links) {
-        std::cout << link.first << ": " << link.second;
-        std::cout << " ";
+        out << link.first << ": " << link.second;
+        out << " ";
     }
-    std::cout << std::endl;
+    out << std::endl;
 }
 
 void TextView::display() const {
+    static Timers::Site site{"TextView::display"};
+    Timers::Scope timer{site};
+    Trace::Span span{"TextView::display", "render"};
     // print other players
     for (auto player : players) {
         if (player.id != game->getPlayerIndex(*viewer)) {
@@ -116,9 +127,9 @@ void TextView::display() const {
     // print the board
     for (auto line : board) {
         for (auto tile : line) {
-            std::cout << tile;
+            out << tile;
         }
-        std::cout << std::endl;
+        out << std::endl;
     }
     printPlayer(players[game->getPlayerIndex(*viewer)]);
 }
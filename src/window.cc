@@ -4,8 +4,7 @@
 #include <X11/Xutil.h>
 #include <unistd.h>
 
-#include <cstdlib>
-#include <iostream>
+#include <stdexcept>
 #include <string>
 
 using namespace std;
@@ -13,8 +12,7 @@ using namespace std;
 Xwindow::Xwindow(int width, int height) : width{width}, height{height} {
     d = XOpenDisplay(NULL);
     if (d == NULL) {
-        cerr << "Cannot open display" << endl;
-        exit(1);
+        throw runtime_error("Cannot open display");
     }
     s = DefaultScreen(d);
     w = XCreateSimpleWindow(d, RootWindow(d, s), 10, 10, width, height, 1,
@@ -52,6 +50,9 @@ Xwindow::Xwindow(int width, int height) : width{width}, height{height} {
     }
 
     XSetForeground(d, gc, colours[Black]);
+    XSetLineAttributes(d, gc, 1, LineSolid, CapRound, JoinRound);
+    gcColour = Black;
+    gcThickness = 1;
 
     // Make window non-resizeable.
     XSizeHints hints;
@@ -90,25 +91,88 @@ void Xwindow::display() {
     XFlush(d);
 }
 
-void Xwindow::fillRectangle(int x, int y, int width, int height, int colour) {
+void Xwindow::displayArea(int x, int y, int width, int height) {
+    XCopyArea(d, pix, w, gc, x, y, width, height, x, y);
+}
+
+void Xwindow::flush() { XFlush(d); }
+
+void Xwindow::sync() { XSync(d, False); }
+
+void Xwindow::setColour(int colour) {
+    if (colour == gcColour) return;
     XSetForeground(d, gc, colours[colour]);
+    gcColour = colour;
+}
+
+void Xwindow::setThickness(int thickness) {
+    if (thickness == gcThickness) return;
+    XSetLineAttributes(d, gc, thickness, LineSolid, CapRound, JoinRound);
+    gcThickness = thickness;
+}
+
+void Xwindow::fillRectangle(int x, int y, int width, int height, int colour) {
+    setColour(colour);
     XFillRectangle(d, pix, gc, x, y, width, height);
-    XSetForeground(d, gc, colours[Black]);
 }
 
-void Xwindow::drawString(int x, int y, string msg) {
+void Xwindow::drawString(int x, int y, const string& msg) {
+    setColour(Black);
     XDrawString(d, pix, gc, x, y, msg.c_str(), msg.length());
 }
 
 void Xwindow::drawLine(int x1, int y1, int x2, int y2, int thickness, int colour) {
-    XSetForeground(d, gc, colours[colour]);
-    XSetLineAttributes(d, gc, thickness, LineSolid, CapRound, JoinRound);
+    setColour(colour);
+    setThickness(thickness);
     XDrawLine(d, pix, gc, x1, y1, x2, y2);
-    XSetLineAttributes(d, gc, 1, LineSolid, CapRound, JoinRound);
-    XSetForeground(d, gc, colours[Black]);
+}
+
+void Xwindow::queueRectangle(int x, int y, int width, int height, int colour) {
+    rectBatch[colour].push_back({(short)x, (short)y, (unsigned short)width,
+                                 (unsigned short)height});
+}
+
+void Xwindow::queueLine(int x1, int y1, int x2, int y2, int thickness, int colour) {
+    segmentBatch[{thickness, colour}].push_back(
+        {(short)x1, (short)y1, (short)x2, (short)y2});
+}
+
+void Xwindow::flushBatch() {
+    // Start with the colour the GC already has to save a state change
+    for (int i = 0; i < 10; ++i) {
+        int colour = (gcColour + i) % 10;
+        auto& rects = rectBatch[colour];
+        if (rects.empty()) continue;
+        setColour(colour);
+        XFillRectangles(d, pix, gc, rects.data(), rects.size());
+        rects.clear();
+    }
+
+    // Sorted by thickness, then colour
+    for (auto& [key, segments] : segmentBatch) {
+        if (segments.empty()) continue;
+        setThickness(key.first);
+        setColour(key.second);
+        XDrawSegments(d, pix, gc, segments.data(), segments.size());
+        segments.clear();
+    }
 }
 
 void Xwindow::clear() {
     XClearWindow(d, w);
     XFlush(d);
 }
+
+bool Xwindow::isInteractive() const { return true; }
+
+int Xwindow::getConnectionFd() const { return ConnectionNumber(d); }
+
+bool Xwindow::handleEvents() {
+    bool exposed = false;
+    while (XPending(d)) {
+        XEvent event;
+        XNextEvent(d, &event);
+        if (event.type == Expose) exposed = true;
+    }
+    return exposed;
+}
@@ -0,0 +1,173 @@
+// Load generator for `RAIInet --server <socket>`.
+//
+// Opens many connections at once, which the server seats in pairs, one game
+// per pair. A connection whose player is to move sends one command and waits
+// for its NUL-terminated reply before sending the next; the other waits to be
+// told the turn has passed to it. A connection whose game ends is replaced by
+// a new one. Prints throughput and round-trip latency percentiles when done.
+//
+// Usage: loadclient <socket> [connections=64] [commands=100000]
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// a short back-and-forth that keeps games going with a mix of commands
+constexpr std::string_view script[] = {
+    "move a N\n", "move a S\n", "board\n", "move a S\n", "move a N\n",
+    "abilities\n",
+};
+
+struct Connection {
+    int fd = -1;
+    unsigned player = 0;   // the seat, from the greeting; 0 until seated
+    bool toMove = false;   // the last turn announced was this player's
+    bool waiting = false;  // a command has been sent but not answered
+    unsigned next = 0;     // index into the script
+    Clock::time_point sentAt;
+    std::string reply;     // the reply being received
+};
+
+int connectTo(const sockaddr_un &address) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr *>(&address),
+                          sizeof(address)) < 0) {
+        std::cerr << "connect: " << std::strerror(errno) << "\n";
+        std::exit(1);
+    }
+    return fd;
+}
+
+// the player named by the last "Player N's turn" in a message, or 0
+unsigned announcedTurn(std::string_view message) {
+    size_t at = message.rfind("'s turn");
+    if (at == std::string_view::npos || at == 0) return 0;
+    return message[at - 1] - '0';
+}
+
+void sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t n = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;  // the server closed the connection; the read sees it
+        }
+        data.remove_prefix(n);
+    }
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <socket> [connections] [commands]\n";
+        return 1;
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, argv[1], sizeof(address.sun_path) - 1);
+    unsigned connections = argc > 2 ? std::atoi(argv[2]) : 64;
+    uint64_t target = argc > 3 ? std::atoll(argv[3]) : 100000;
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Connection> conns(connections);
+    auto open = [&](unsigned i) {
+        Connection &c = conns[i];
+        c = {};
+        c.fd = connectTo(address);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, c.fd, &event);
+    };
+    for (unsigned i = 0; i < connections; ++i) open(i);
+
+    std::vector<uint32_t> latencies;
+    latencies.reserve(target);
+    uint64_t sent = 0;
+    uint64_t games = 0;
+    auto started = Clock::now();
+
+    auto sendNext = [&](Connection &c) {
+        c.sentAt = Clock::now();
+        c.waiting = true;
+        sendAll(c.fd, script[c.next]);
+        c.next = (c.next + 1) % std::size(script);
+        ++sent;
+    };
+
+    std::vector<char> buffer(1 << 16);
+    epoll_event events[64];
+    while (latencies.size() < target) {
+        int n = epoll_wait(epollFd, events, 64, -1);
+        if (n < 0 && errno == EINTR) continue;
+        for (int e = 0; e < n; ++e) {
+            unsigned i = events[e].data.u32;
+            Connection &c = conns[i];
+            ssize_t got = recv(c.fd, buffer.data(), buffer.size(), 0);
+            if (got <= 0) {
+                // game over; start another, resending a lost command
+                if (c.waiting) --sent;
+                close(c.fd);
+                ++games;
+                open(i);
+                continue;
+            }
+            c.reply.append(buffer.data(), got);
+            size_t end;
+            while ((end = c.reply.find('\0')) != std::string::npos) {
+                std::string_view message{c.reply.data(), end};
+                if (c.player == 0) {
+                    c.player = std::atoi(message.data() +
+                                         std::strlen("You are player "));
+                }
+                if (unsigned turn = announcedTurn(message)) {
+                    c.toMove = turn == c.player;
+                }
+                c.reply.erase(0, end + 1);
+                if (c.waiting) {
+                    c.waiting = false;
+                    auto took = Clock::now() - c.sentAt;
+                    latencies.push_back(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            took)
+                            .count());
+                }
+                if (c.toMove && sent < target) sendNext(c);
+            }
+        }
+    }
+    double seconds =
+        std::chrono::duration<double>(Clock::now() - started).count();
+
+    std::cout << latencies.size() << " commands over " << connections
+              << " connections in " << seconds << " s ("
+              << latencies.size() / seconds << " commands/s), " << games
+              << " games finished\n";
+    std::cout << "Round trip (us):";
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        auto at = latencies.begin() + size_t(q * (latencies.size() - 1));
+        std::nth_element(latencies.begin(), at, latencies.end());
+        std::cout << " p" << q * 100 << " " << *at / 1000.0;
+    }
+    std::cout << " max "
+              << *std::max_element(latencies.begin(), latencies.end()) / 1000.0
+              << "\n";
+    for (auto &c : conns) close(c.fd);
+    close(epollFd);
+}
@@ -0,0 +1,276 @@
+// Performance gate: replays a corpus of game scripts through the headless
+// engine and compares throughput, command latency and the final state of
+// every game with a baseline.
+//
+// The baseline lists the corpus, one line per script:
+//     game <script> <repeat> <state hash>
+// Each script is played from a new game set up as the scripts in tests/
+// expect (tests/defaultlinks for both players, abilities LFQPS and LFDPS),
+// repeat times over unless the game ends first. The hash is of the game's
+// final state, so any change to how games turn out fails the gate whatever
+// the timings. The baseline also holds the figures measured when it was
+// written:
+//     optimized <0 or 1>
+//     throughput <commands per second>
+//     p50 <microseconds>
+//     p99 <microseconds>
+// The corpus is replayed `rounds` times; throughput is that of the fastest
+// round and the percentiles are over every command of every round. A
+// figure more than `tolerance` (a fraction) worse than the baseline fails.
+//
+// Usage: perfreplay [--update] [--tolerance 0.25] [--rounds 5] <baseline>
+// With --update the baseline is rewritten with the measured figures and
+// hashes instead of being checked. Run from the repository root, since
+// scripts name each other relative to it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "controller.h"
+#include "gamestate.h"
+#include "histogram.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+std::ostream nowhere{nullptr};  // the games print to nothing
+
+struct Entry {
+    std::string script;
+    unsigned repeat = 1;
+    std::string hash; /**< Expected, from the baseline. */
+    std::vector<std::string> lines;
+    std::string measuredHash;
+    uint64_t commands = 0; /**< Per round. */
+};
+
+struct Figures {
+    bool optimized = false;
+    double throughput = 0; /**< Commands per second. */
+    double p50 = 0;        /**< Microseconds. */
+    double p99 = 0;        /**< Microseconds. */
+};
+
+#ifdef __OPTIMIZE__
+constexpr bool optimized = true;
+#else
+constexpr bool optimized = false;
+#endif
+
+std::string hexHash(const GameState &state) {
+    // FNV-1a over the raw struct, as saved games store it
+    uint64_t hash = 14695981039346656037ull;
+    auto bytes = reinterpret_cast<const unsigned char *>(&state);
+    for (std::size_t i = 0; i < sizeof(state); ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", (unsigned long long)hash);
+    return text;
+}
+
+std::vector<std::string> readScript(const std::string &path) {
+    std::ifstream file{path};
+    if (!file) throw std::runtime_error("Cannot read " + path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos) continue;
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+void readBaseline(const std::string &path, std::vector<Entry> &games,
+                  Figures &figures) {
+    std::ifstream file{path};
+    if (!file) throw std::runtime_error("Cannot read " + path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream words{line};
+        std::string key;
+        if (!(words >> key) || key[0] == '#') continue;
+        if (key == "game") {
+            Entry entry;
+            words >> entry.script >> entry.repeat >> entry.hash;
+            if (!words || entry.repeat == 0) {
+                throw std::runtime_error("Bad line in " + path + ": " + line);
+            }
+            games.push_back(std::move(entry));
+        } else if (key == "optimized") {
+            words >> figures.optimized;
+        } else if (key == "throughput") {
+            words >> figures.throughput;
+        } else if (key == "p50") {
+            words >> figures.p50;
+        } else if (key == "p99") {
+            words >> figures.p99;
+        } else {
+            throw std::runtime_error("Bad line in " + path + ": " + line);
+        }
+    }
+}
+
+void writeBaseline(const std::string &path, const std::vector<Entry> &games,
+                   const Figures &figures) {
+    std::ofstream file{path};
+    file << "# Baseline for `make perf`; rewrite with `make perf-baseline`.\n"
+         << "# Add scripts by adding game lines: game <script> <repeat> -\n"
+         << "optimized " << figures.optimized << "\n"
+         << "throughput " << figures.throughput << "\n"
+         << "p50 " << figures.p50 << "\n"
+         << "p99 " << figures.p99 << "\n";
+    for (const auto &game : games) {
+        file << "game " << game.script << " " << game.repeat << " "
+             << game.measuredHash << "\n";
+    }
+    if (!file) throw std::runtime_error("Cannot write " + path);
+}
+
+// plays every game once; returns the time spent running commands
+Clock::duration playRound(std::vector<Entry> &games, Histogram &latency) {
+    GameConfig config;
+    config.abilities = {"LFQPS", "LFDPS"};
+    config.linkFiles = {"tests/defaultlinks", "tests/defaultlinks"};
+
+    Clock::duration total{};
+    for (auto &game : games) {
+        Controller controller{nowhere};
+        controller.start(config);
+        game.commands = 0;
+        auto started = Clock::now();
+        for (unsigned r = 0; r < game.repeat && controller.isRunning(); ++r) {
+            for (const auto &line : game.lines) {
+                if (!controller.isRunning()) break;
+                auto begun = Clock::now();
+                controller.runCommands(line);
+                controller.updateViews();
+                latency.record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - begun)
+                        .count());
+                ++game.commands;
+            }
+        }
+        total += Clock::now() - started;
+        game.measuredHash =
+            hexHash(GameState::capture(controller.getGame()));
+    }
+    return total;
+}
+
+// prints one figure against the baseline; returns whether it is in bounds
+bool compare(const char *name, double measured, double baseline,
+             double tolerance, bool higherIsBetter) {
+    double change = baseline > 0 ? (measured - baseline) / baseline : 0;
+    double worse = higherIsBetter ? -change : change;
+    bool ok = worse <= tolerance;
+    std::printf("%-11s %12.2f   baseline %12.2f   %+6.1f%%   %s\n", name,
+                measured, baseline, change * 100, ok ? "ok" : "REGRESSED");
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    bool update = false;
+    double tolerance = 0.25;
+    unsigned rounds = 5;
+    std::string baselinePath;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = std::max(1, std::atoi(argv[++i]));
+        } else {
+            baselinePath = argv[i];
+        }
+    }
+    if (baselinePath.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--update] [--tolerance fraction] [--rounds n] "
+                     "<baseline>\n";
+        return 2;
+    }
+
+    try {
+        std::vector<Entry> games;
+        Figures baseline;
+        readBaseline(baselinePath, games, baseline);
+        for (auto &game : games) game.lines = readScript(game.script);
+
+        Histogram latency;
+        Clock::duration best = Clock::duration::max();
+        uint64_t commands = 0;
+        for (unsigned r = 0; r < rounds; ++r) {
+            best = std::min(best, playRound(games, latency));
+        }
+        for (const auto &game : games) commands += game.commands;
+
+        Figures measured;
+        measured.optimized = optimized;
+        measured.throughput =
+            commands / std::chrono::duration<double>(best).count();
+        measured.p50 = latency.percentile(0.5) / 1000.0;
+        measured.p99 = latency.percentile(0.99) / 1000.0;
+
+        if (update) {
+            writeBaseline(baselinePath, games, measured);
+            std::cout << "Wrote " << baselinePath << ": " << commands
+                      << " commands, " << measured.throughput
+                      << " commands/s\n";
+            return 0;
+        }
+
+        unsigned failures = 0;
+        for (const auto &game : games) {
+            bool same = game.measuredHash == game.hash;
+            std::printf("%-24s %6llu commands   state %s   %s\n",
+                        game.script.c_str(), (unsigned long long)game.commands,
+                        game.measuredHash.c_str(),
+                        same ? "ok" : "CHANGED");
+            if (!same) {
+                std::printf("  expected state %s; the game no longer ends "
+                            "the same way\n",
+                            game.hash.c_str());
+                ++failures;
+            }
+        }
+        if (baseline.optimized != measured.optimized) {
+            std::printf("The baseline was measured with optimized=%d but this "
+                        "build has optimized=%d; timings not compared\n",
+                        baseline.optimized, measured.optimized);
+            ++failures;
+        } else {
+            failures += !compare("throughput", measured.throughput,
+                                 baseline.throughput, tolerance, true);
+            failures += !compare("p50 (us)", measured.p50, baseline.p50,
+                                 tolerance, false);
+            failures += !compare("p99 (us)", measured.p99, baseline.p99,
+                                 tolerance, false);
+        }
+        if (failures) {
+            std::printf("PERF FAILED: %u problem%s (tolerance %.0f%%)\n",
+                        failures, failures == 1 ? "" : "s", tolerance * 100);
+            return 1;
+        }
+        std::printf("PERF OK (tolerance %.0f%%)\n", tolerance * 100);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+}
@@ -0,0 +1,153 @@
+// Reader for the state published by `RAIInet --shm <name>`.
+//
+// Prints the board, scores and turn from the shared memory segment. With -f
+// it prints again after every publish until interrupted. With -s it reads
+// as fast as it can for the given number of seconds, checking that every
+// read is consistent (links and the cells they occupy agree), and prints the
+// read rate and how many reads raced a publish.
+//
+// Usage: shmreader <name> [-f | -s seconds]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "gamestate.h"
+#include "sharedstate.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr char linkBase[GameState::maxPlayers] = {'a', 'A', 'h', 'H'};
+
+char cellChar(const GameState &state, unsigned r, unsigned c) {
+    const auto &cell = state.cells[r][c];
+    bool server = false;
+    bool goal = false;
+    uint8_t firewall = GameState::none;
+    for (unsigned i = 0; i < cell.layerCount; ++i) {
+        if (cell.layers[i] == GameState::Server) server = true;
+        if (cell.layers[i] == GameState::Goal) goal = true;
+        if (cell.layers[i] == GameState::Firewall) firewall = cell.owners[i];
+    }
+    if (server) return 'S';
+    if (cell.occupantPlayer != GameState::none) {
+        return linkBase[cell.occupantPlayer] + cell.occupantId;
+    }
+    if (goal) return '=';
+    if (firewall != GameState::none) return firewall == 0 ? 'm' : 'w';
+    return '.';
+}
+
+void print(const GameState &state, uint32_t sequence) {
+    std::cout << "Turn " << state.turn << ", player "
+              << state.currentPlayer + 1 << " to move (sequence " << sequence
+              << ")\n";
+    for (unsigned p = 0; p < state.playerCount; ++p) {
+        const auto &player = state.players[p];
+        std::cout << "Player " << p + 1 << ": ";
+        if (!player.alive) {
+            std::cout << "out\n";
+            continue;
+        }
+        std::cout << player.data << "D, " << player.viruses << "V, "
+                  << player.abilityCount - player.abilitiesUsed
+                  << " abilities\n";
+    }
+    for (unsigned r = 0; r < GameState::rows; ++r) {
+        for (unsigned c = 0; c < GameState::cols; ++c) {
+            std::cout << cellChar(state, r, c);
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+// whether every link on the board and the cell it is on agree
+bool consistent(const GameState &state) {
+    if (state.playerCount > GameState::maxPlayers) return false;
+    for (unsigned p = 0; p < state.playerCount; ++p) {
+        for (unsigned id = 0; id < GameState::linksPerPlayer; ++id) {
+            const auto &link = state.players[p].links[id];
+            if (!link.present) continue;
+            if (link.row < 0 || link.row >= int(GameState::rows) ||
+                link.col < 0 || link.col >= int(GameState::cols)) {
+                return false;
+            }
+            const auto &cell = state.cells[link.row][link.col];
+            if (cell.occupantPlayer != p || cell.occupantId != id) {
+                return false;
+            }
+        }
+    }
+    for (unsigned r = 0; r < GameState::rows; ++r) {
+        for (unsigned c = 0; c < GameState::cols; ++c) {
+            const auto &cell = state.cells[r][c];
+            if (cell.occupantPlayer == GameState::none) continue;
+            if (cell.occupantPlayer >= state.playerCount ||
+                cell.occupantId >= GameState::linksPerPlayer) {
+                return false;
+            }
+            const auto &link =
+                state.players[cell.occupantPlayer].links[cell.occupantId];
+            if (!link.present || link.row != int(r) || link.col != int(c)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <name> [-f | -s seconds]\n";
+        return 1;
+    }
+    try {
+        StateSubscriber subscriber{argv[1]};
+        GameState state;
+
+        if (argc > 3 && std::strcmp(argv[2], "-s") == 0) {
+            auto until = Clock::now() + std::chrono::duration<double>(
+                                            std::atof(argv[3]));
+            uint64_t reads = 0;
+            uint64_t torn = 0;
+            uint64_t publishes = 0;
+            uint32_t last = subscriber.read(state);
+            auto started = Clock::now();
+            while (Clock::now() < until) {
+                uint32_t sequence = subscriber.read(state);
+                ++reads;
+                if (sequence != last) publishes += (sequence - last) / 2;
+                last = sequence;
+                if (!consistent(state)) ++torn;
+            }
+            double seconds =
+                std::chrono::duration<double>(Clock::now() - started).count();
+            std::cout << reads << " reads in " << seconds << " s ("
+                      << reads / seconds << " reads/s) over " << publishes
+                      << " publishes, " << torn << " inconsistent\n";
+            return torn == 0 ? 0 : 1;
+        }
+
+        uint32_t sequence = subscriber.read(state);
+        print(state, sequence);
+        if (argc > 2 && std::strcmp(argv[2], "-f") == 0) {
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                if (subscriber.getSequence() == sequence) continue;
+                sequence = subscriber.read(state);
+                std::cout << "\n";
+                print(state, sequence);
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}